@@ -0,0 +1,444 @@
+/*!
+ *****************************************************************************
+  @file:  adi_console_io.c
+
+  @brief: Console input/output channel for the console menu library
+
+  @details: Console input is received into a RX ring buffer, fed either from
+            the UART RX interrupt/callback (adi_console_rx_push) or by polling
+            a non-blocking UART read function. This allows the console menu
+            to be processed without blocking into getchar().
+            When the RX ring buffer is not enabled, console input is read
+            using the standard getchar().
+            Input can also be injected by the application, in which case it
+            is read before any input received from the UART.
+            Console output is written into a TX ring buffer drained by UART
+            DMA/interrupt transfers, so that the caller only pays for the
+            copy into the buffer. When the TX ring buffer is not enabled,
+            console output is written to stdout.
+ -----------------------------------------------------------------------------
+ Copyright (c) 2023 Analog Devices, Inc.
+ All rights reserved.
+
+ This software is proprietary to Analog Devices, Inc. and its licensors.
+ By using this software you agree to the terms of the associated
+ Analog Devices Software License Agreement.
+
+*****************************************************************************/
+
+/****************************************************************************/
+/***************************** Include Files ********************************/
+/****************************************************************************/
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <errno.h>
+
+#include "adi_console_io.h"
+
+/****************************************************************************/
+/********************** Macros and Constants Definition *********************/
+/****************************************************************************/
+#if (ADI_CONSOLE_RX_BUF_LEN & (ADI_CONSOLE_RX_BUF_LEN - 1))
+#error "ADI_CONSOLE_RX_BUF_LEN must be power of 2"
+#endif
+
+#if (ADI_CONSOLE_TX_BUF_LEN & (ADI_CONSOLE_TX_BUF_LEN - 1))
+#error "ADI_CONSOLE_TX_BUF_LEN must be power of 2"
+#endif
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+// RX ring buffer. Written by the UART RX callback, read by the console menu.
+static struct {
+	char buf[ADI_CONSOLE_RX_BUF_LEN];
+	volatile uint16_t head;
+	volatile uint16_t tail;
+	// Non-blocking UART read, polled when ring buffer is empty
+	adi_console_rx_poll_fn poll;
+	bool enabled;
+} adi_console_rx;
+
+// TX ring buffer. Written by the console output functions, drained by the
+// UART DMA/interrupt transfers.
+static struct {
+	uint8_t buf[ADI_CONSOLE_TX_BUF_LEN];
+	volatile uint16_t head;
+	volatile uint16_t tail;
+	// Length of the ongoing transfer
+	volatile uint16_t xfer_len;
+	volatile bool busy;
+	adi_console_tx_start_fn start;
+	enum adi_console_tx_overflow_policy policy;
+	// Number of bytes dropped due to overflow
+	uint32_t dropped;
+	bool enabled;
+} adi_console_tx;
+
+// Input injected by the application
+static struct {
+	char buf[ADI_CONSOLE_INJECT_BUF_LEN];
+	uint16_t len;
+	uint16_t pos;
+} adi_console_inject;
+
+/****************************************************************************/
+/***************************** Function Definitions *************************/
+/****************************************************************************/
+/*!
+ * @brief      Enables the console RX ring buffer
+ *
+ * @param      poll non-blocking UART read function, NULL if the ring buffer
+ *             is fed from the UART RX callback through adi_console_rx_push()
+ */
+void adi_console_rx_enable(adi_console_rx_poll_fn poll)
+{
+	adi_console_rx.head = 0;
+	adi_console_rx.tail = 0;
+	adi_console_rx.poll = poll;
+	adi_console_rx.enabled = true;
+}
+
+/*!
+ * @brief      Disables the console RX ring buffer, getchar() is used again
+ */
+void adi_console_rx_disable(void)
+{
+	adi_console_rx.enabled = false;
+}
+
+/*!
+ * @brief      Checks if the console RX ring buffer is enabled
+ *
+ * @return     true if enabled, false otherwise
+ */
+bool adi_console_rx_is_enabled(void)
+{
+	return adi_console_rx.enabled;
+}
+
+/*!
+ * @brief      Stores a received character into the RX ring buffer
+ *
+ * @param      ch received character
+ *
+ * @details    Meant to be called from the UART RX interrupt/callback.
+ *             The character is dropped if the ring buffer is full.
+ */
+void adi_console_rx_push(char ch)
+{
+	uint16_t head = adi_console_rx.head;
+
+	if ((uint16_t)(head - adi_console_rx.tail) >= ADI_CONSOLE_RX_BUF_LEN) {
+		return;
+	}
+
+	adi_console_rx.buf[head & (ADI_CONSOLE_RX_BUF_LEN - 1)] = ch;
+	adi_console_rx.head = head + 1;
+}
+
+/*!
+ * @brief      Reads a character from the RX ring buffer without blocking
+ *
+ * @param      ch read character
+ *
+ * @return     0 if a character is read, -EAGAIN if no input is available
+ */
+int32_t adi_console_rx_pop(char *ch)
+{
+	uint16_t tail = adi_console_rx.tail;
+
+	if (adi_console_inject.pos < adi_console_inject.len) {
+		*ch = adi_console_inject.buf[adi_console_inject.pos++];
+		return 0;
+	}
+
+	if (tail == adi_console_rx.head) {
+		if (adi_console_rx.poll != NULL && !adi_console_rx.poll(ch)) {
+			return 0;
+		}
+		return -EAGAIN;
+	}
+
+	*ch = adi_console_rx.buf[tail & (ADI_CONSOLE_RX_BUF_LEN - 1)];
+	adi_console_rx.tail = tail + 1;
+
+	return 0;
+}
+
+/*!
+ * @brief      Reads a character from the console, waiting for it if needed
+ *
+ * @return     character read
+ */
+char adi_console_getchar(void)
+{
+	char ch;
+
+	if (adi_console_inject.pos < adi_console_inject.len) {
+		return adi_console_inject.buf[adi_console_inject.pos++];
+	}
+
+	if (!adi_console_rx.enabled) {
+		return getchar();
+	}
+
+	while (adi_console_rx_pop(&ch)) ;
+
+	return ch;
+}
+
+/*!
+ * @brief      Enables the console TX ring buffer
+ *
+ * @param      start function starting the UART DMA/interrupt transfer
+ * @param      policy overflow policy
+ */
+void adi_console_tx_enable(adi_console_tx_start_fn start,
+			   enum adi_console_tx_overflow_policy policy)
+{
+	if (start == NULL) {
+		return;
+	}
+
+	adi_console_tx.head = 0;
+	adi_console_tx.tail = 0;
+	adi_console_tx.xfer_len = 0;
+	adi_console_tx.busy = false;
+	adi_console_tx.start = start;
+	adi_console_tx.policy = policy;
+	adi_console_tx.dropped = 0;
+	adi_console_tx.enabled = true;
+}
+
+/*!
+ * @brief      Disables the console TX ring buffer, stdout is used again
+ *
+ * @details    The pending output is sent out first.
+ */
+void adi_console_tx_disable(void)
+{
+	adi_console_flush();
+	adi_console_tx.enabled = false;
+}
+
+/*!
+ * @brief      Starts the transfer of the next contiguous block of the TX
+ *             ring buffer, if any
+ */
+static void adi_console_tx_start_next(void)
+{
+	uint16_t tail = adi_console_tx.tail;
+	uint16_t pending = adi_console_tx.head - tail;
+	uint16_t offset = tail & (ADI_CONSOLE_TX_BUF_LEN - 1);
+
+	if (pending == 0) {
+		adi_console_tx.busy = false;
+		return;
+	}
+
+	// Transfer up to the end of the buffer, the rest is sent next
+	if (pending > ADI_CONSOLE_TX_BUF_LEN - offset) {
+		pending = ADI_CONSOLE_TX_BUF_LEN - offset;
+	}
+
+	adi_console_tx.busy = true;
+	adi_console_tx.xfer_len = pending;
+	if (adi_console_tx.start(&adi_console_tx.buf[offset], pending)) {
+		// Transfer couldn't be started, it is retried on next write/flush
+		adi_console_tx.xfer_len = 0;
+		adi_console_tx.busy = false;
+	}
+}
+
+/*!
+ * @brief      Handles the end of a console TX transfer
+ *
+ * @details    Meant to be called from the UART DMA/interrupt TX complete
+ *             callback. Frees the transferred block and starts the next one.
+ */
+void adi_console_tx_complete(void)
+{
+	adi_console_tx.tail += adi_console_tx.xfer_len;
+	adi_console_tx.xfer_len = 0;
+	adi_console_tx_start_next();
+}
+
+/*!
+ * @brief      Writes data to the console
+ *
+ * @param      data data to write
+ * @param      len number of bytes
+ *
+ * @return     number of bytes written
+ *
+ * @details    With the TX ring buffer enabled, data is only copied into the
+ *             buffer and the transfer started if the UART is idle.
+ */
+int32_t adi_console_write(const char *data, uint16_t len)
+{
+	uint16_t space;
+	uint16_t offset;
+	uint16_t chunk;
+	uint16_t written = 0;
+
+	if (!adi_console_tx.enabled) {
+		return fwrite(data, 1, len, stdout);
+	}
+
+	while (written < len) {
+		space = ADI_CONSOLE_TX_BUF_LEN - (uint16_t)(adi_console_tx.head -
+				adi_console_tx.tail);
+		if (space == 0) {
+			if (adi_console_tx.policy == ADI_CONSOLE_TX_OVERFLOW_DROP) {
+				adi_console_tx.dropped += len - written;
+				break;
+			}
+			if (!adi_console_tx.busy) {
+				adi_console_tx_start_next();
+			}
+			continue;
+		}
+
+		offset = adi_console_tx.head & (ADI_CONSOLE_TX_BUF_LEN - 1);
+		chunk = len - written;
+		if (chunk > space) {
+			chunk = space;
+		}
+		if (chunk > ADI_CONSOLE_TX_BUF_LEN - offset) {
+			chunk = ADI_CONSOLE_TX_BUF_LEN - offset;
+		}
+
+		memcpy(&adi_console_tx.buf[offset], &data[written], chunk);
+		adi_console_tx.head += chunk;
+		written += chunk;
+	}
+
+	// Head is updated before checking the UART state, so that the data is
+	// picked by either this start or the TX complete callback
+	if (!adi_console_tx.busy) {
+		adi_console_tx_start_next();
+	}
+
+	return written;
+}
+
+/*!
+ * @brief      Writes formatted output to the console
+ *
+ * @param      format printf-like format string
+ *
+ * @return     number of bytes written
+ */
+int32_t adi_console_printf(const char *format, ...)
+{
+	char buf[ADI_CONSOLE_PRINTF_BUF_LEN];
+	va_list args;
+	int len;
+
+	va_start(args, format);
+	if (!adi_console_tx.enabled) {
+		len = vprintf(format, args);
+		va_end(args);
+		return len;
+	}
+
+	len = vsnprintf(buf, sizeof(buf), format, args);
+	va_end(args);
+
+	if (len < 0) {
+		return len;
+	}
+
+	if (len < (int)sizeof(buf)) {
+		return adi_console_write(buf, len);
+	}
+
+	// Too long to be formatted locally, written directly once the pending
+	// output is sent out to preserve the ordering
+	adi_console_flush();
+	va_start(args, format);
+	len = vprintf(format, args);
+	va_end(args);
+	fflush(stdout);
+
+	return len;
+}
+
+/*!
+ * @brief      Writes a character to the console
+ *
+ * @param      ch character
+ */
+void adi_console_putchar(char ch)
+{
+	if (!adi_console_tx.enabled) {
+		putchar(ch);
+		return;
+	}
+
+	adi_console_write(&ch, 1);
+}
+
+/*!
+ * @brief      Waits for all the console output to be sent out
+ *
+ * @details    Must be called before writing to the UART through other means
+ *             (e.g. printf) to preserve the output ordering.
+ */
+void adi_console_flush(void)
+{
+	if (!adi_console_tx.enabled) {
+		fflush(stdout);
+		return;
+	}
+
+	while (adi_console_tx.head != adi_console_tx.tail) {
+		if (!adi_console_tx.busy) {
+			adi_console_tx_start_next();
+		}
+	}
+}
+
+/*!
+ * @brief      Returns the number of output bytes dropped due to overflow
+ *
+ * @return     number of bytes dropped
+ */
+uint32_t adi_console_get_tx_dropped(void)
+{
+	return adi_console_tx.dropped;
+}
+
+/*!
+ * @brief      Injects input to be read as if typed by the user
+ *
+ * @param      input characters to inject
+ * @param      len number of characters
+ *
+ * @return     0 in case of success, -ENOBUFS if input doesn't fit
+ *
+ * @details    Any previously injected input not read yet is discarded.
+ */
+int32_t adi_console_inject_input(const char *input, uint16_t len)
+{
+	if (len > sizeof(adi_console_inject.buf)) {
+		return -ENOBUFS;
+	}
+
+	memcpy(adi_console_inject.buf, input, len);
+	adi_console_inject.len = len;
+	adi_console_inject.pos = 0;
+
+	return 0;
+}
+
+/*!
+ * @brief      Discards the injected input not read yet
+ */
+void adi_console_clear_injected_input(void)
+{
+	adi_console_inject.len = 0;
+	adi_console_inject.pos = 0;
+}
@@ -0,0 +1,93 @@
+/*!
+ *****************************************************************************
+  @file:  adi_console_io.h
+
+  @brief:   Console input/output channel for the console menu library
+
+  @details:
+ -----------------------------------------------------------------------------
+ Copyright (c) 2023 Analog Devices, Inc.
+ All rights reserved.
+
+ This software is proprietary to Analog Devices, Inc. and its licensors.
+ By using this software you agree to the terms of the associated
+ Analog Devices Software License Agreement.
+
+*****************************************************************************/
+
+#ifndef ADI_CONSOLE_IO_H_
+#define ADI_CONSOLE_IO_H_
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+
+/******************************************************************************/
+/********************** Macros and Constants Definition ***********************/
+/******************************************************************************/
+
+/* Size of the console RX ring buffer (must be power of 2) */
+#ifndef ADI_CONSOLE_RX_BUF_LEN
+#define ADI_CONSOLE_RX_BUF_LEN		64
+#endif
+
+/* Size of the console TX ring buffer (must be power of 2) */
+#ifndef ADI_CONSOLE_TX_BUF_LEN
+#define ADI_CONSOLE_TX_BUF_LEN		1024
+#endif
+
+/* Size of the buffer used to format the console output */
+#ifndef ADI_CONSOLE_PRINTF_BUF_LEN
+#define ADI_CONSOLE_PRINTF_BUF_LEN	128
+#endif
+
+/* Size of the buffer holding input injected by the application */
+#ifndef ADI_CONSOLE_INJECT_BUF_LEN
+#define ADI_CONSOLE_INJECT_BUF_LEN	64
+#endif
+
+/******************************************************************************/
+/********************** Variables and User Defined Data Types *****************/
+/******************************************************************************/
+
+// Function polled to read a character from the UART without blocking.
+// Returns 0 when a character is read, non-zero when no data is available
+typedef int32_t (*adi_console_rx_poll_fn)(char *ch);
+
+// Function starting the UART transfer (DMA or interrupt driven) of a block
+// of the TX ring buffer. adi_console_tx_complete() must be called once the
+// transfer is done. Returns 0 when the transfer is started.
+typedef int32_t (*adi_console_tx_start_fn)(const uint8_t *data, uint16_t len);
+
+// Policy applied when the console output doesn't fit into the TX ring buffer
+enum adi_console_tx_overflow_policy {
+	// Wait for the ongoing transfers to free enough space
+	ADI_CONSOLE_TX_OVERFLOW_WAIT,
+	// Drop the output which doesn't fit
+	ADI_CONSOLE_TX_OVERFLOW_DROP
+};
+
+/******************************************************************************/
+/*****************************  Public Declarations ***************************/
+/******************************************************************************/
+void adi_console_rx_enable(adi_console_rx_poll_fn poll);
+void adi_console_rx_disable(void);
+bool adi_console_rx_is_enabled(void);
+void adi_console_rx_push(char ch);
+int32_t adi_console_rx_pop(char *ch);
+char adi_console_getchar(void);
+void adi_console_tx_enable(adi_console_tx_start_fn start,
+			   enum adi_console_tx_overflow_policy policy);
+void adi_console_tx_disable(void);
+void adi_console_tx_complete(void);
+int32_t adi_console_write(const char *data, uint16_t len);
+int32_t adi_console_printf(const char *format, ...);
+void adi_console_putchar(char ch);
+void adi_console_flush(void);
+uint32_t adi_console_get_tx_dropped(void);
+int32_t adi_console_inject_input(const char *input, uint16_t len);
+void adi_console_clear_injected_input(void);
+
+#endif /* ADI_CONSOLE_IO_H_ */
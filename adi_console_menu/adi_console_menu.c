@@ -26,6 +26,7 @@
 #include <ctype.h>
 #include <string.h>
 #include <stdbool.h>
+#include <stdarg.h>
 #include <assert.h>
 
 #include "adi_console_menu.h"
@@ -35,65 +36,816 @@
 /****************************************************************************/
 #define DIV_STRING "\t=================================================="
 
+/* Console line where the menu title is displayed after clearing the console */
+#define ADI_CONSOLE_MENU_FIRST_LINE	2
+
+/* Number of characters of the job progress bar */
+#define ADI_CONSOLE_MENU_PROGRESS_WIDTH	20
+
+/* Console column of the dashboard labels (after the leading tab) */
+#define ADI_CONSOLE_DASHBOARD_LABEL_COL	9
+
+/* Unchanged dashboard characters are rewritten rather than skipped when
+ * they are fewer than the bytes of the cursor move skipping them */
+#define ADI_CONSOLE_DASHBOARD_MIN_GAP	8
+
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
 /******************************************************************************/
 // Save the state of console menu library
 console_menu_state adi_console_menu_state = {
-	.last_error_code = 0
+	.last_error_code = 0,
+	.command_mode = false
 };
 
+// Buffer used to render the menu before writing it to the console
+static struct {
+	char buf[ADI_CONSOLE_MENU_OUT_BUF_LEN];
+	uint16_t len;
+} adi_console_menu_out;
+
+// Last menu frame displayed onto the console, used for partial redraw
+static struct {
+	// Menu displayed
+	const console_menu *menu;
+	// Hash of each displayed line
+	uint32_t hash[ADI_CONSOLE_MENU_MAX_LINES];
+	// Number of lines in the current and previous frame
+	uint16_t lines;
+	uint16_t prev_lines;
+	// Console still holds the displayed frame
+	bool valid;
+} adi_console_menu_frame;
+
+// Dashboard displayed onto the console, used for partial refresh
+static struct {
+	// Dashboard displayed
+	const console_dashboard *dashboard;
+	// Displayed value of each slot
+	char value[ADI_CONSOLE_DASHBOARD_MAX_SLOTS][ADI_CONSOLE_DASHBOARD_VALUE_LEN];
+	// Console column of the values
+	uint16_t value_col;
+	// Console line below the dashboard, where the cursor is parked
+	uint16_t prompt_line;
+	// Time of the last refresh
+	uint32_t last_refresh_ms;
+	// Sub menu entered from the dashboard
+	console_menu_engine submenu;
+	// Console still holds the displayed dashboard
+	bool valid;
+} adi_console_dashboard_frame;
+
 /****************************************************************************/
 /***************************** Function Definitions *************************/
 /****************************************************************************/
 /*!
- * @brief      displays the text of a console menu
+ * @brief      Writes the rendered menu buffer to the console
+ *
+ * @details    The whole buffer is written in one go instead of many small
+ *             printf/putchar calls.
+ */
+static void adi_console_menu_flush(void)
+{
+	if (adi_console_menu_out.len > 0) {
+		adi_console_write(adi_console_menu_out.buf, adi_console_menu_out.len);
+		adi_console_menu_out.len = 0;
+	}
+}
+
+/*!
+ * @brief      Appends formatted text to the menu render buffer
+ *
+ * @details    Buffer is flushed to console when it runs out of space. Text
+ *             which does not fit even into an empty buffer is written directly.
+ */
+static void adi_console_menu_append(const char *format, ...)
+{
+	va_list args;
+	int len;
+	uint16_t space = sizeof(adi_console_menu_out.buf) - adi_console_menu_out.len;
+
+	va_start(args, format);
+	len = vsnprintf(&adi_console_menu_out.buf[adi_console_menu_out.len], space,
+			format, args);
+	va_end(args);
+
+	if (len < 0) {
+		return;
+	}
+
+	if (len < space) {
+		adi_console_menu_out.len += len;
+		return;
+	}
+
+	// Not enough space, flush what was rendered so far and retry
+	adi_console_menu_flush();
+	va_start(args, format);
+	if (len < (int)sizeof(adi_console_menu_out.buf)) {
+		adi_console_menu_out.len = vsnprintf(adi_console_menu_out.buf,
+						     sizeof(adi_console_menu_out.buf), format, args);
+	} else {
+		adi_console_flush();
+		vprintf(format, args);
+	}
+	va_end(args);
+}
+
+/*!
+ * @brief      Computes the FNV-1a hash of a menu line
+ */
+static uint32_t adi_console_menu_line_hash(const char *line)
+{
+	uint32_t hash = 2166136261u;
+
+	while (*line) {
+		hash ^= (uint8_t)*line++;
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
+/*!
+ * @brief      Renders one line of the menu body
+ *
+ * @details    On full redraw the line is appended as is. On partial redraw
+ *             the line is appended (cursor addressed) only if its content has
+ *             changed since the last time the menu was displayed.
+ */
+static void adi_console_menu_put_line(bool full_redraw, const char *format, ...)
+{
+	char line[ADI_CONSOLE_MENU_LINE_LEN];
+	uint16_t line_num = adi_console_menu_frame.lines;
+	uint32_t hash;
+	va_list args;
+
+	va_start(args, format);
+	vsnprintf(line, sizeof(line), format, args);
+	va_end(args);
+
+	hash = adi_console_menu_line_hash(line);
+
+	if (full_redraw) {
+		adi_console_menu_append("%s" EOL, line);
+	} else if (line_num >= ADI_CONSOLE_MENU_MAX_LINES ||
+		   line_num >= adi_console_menu_frame.prev_lines ||
+		   adi_console_menu_frame.hash[line_num] != hash) {
+		adi_console_menu_append(VT100_MOVE_TO_LINE "%s" VT100_CLEAR_LINE_END,
+					ADI_CONSOLE_MENU_FIRST_LINE + line_num, line);
+	}
+
+	if (line_num < ADI_CONSOLE_MENU_MAX_LINES) {
+		adi_console_menu_frame.hash[line_num] = hash;
+	}
+	adi_console_menu_frame.lines++;
+}
+
+/*!
+ * @brief      displays the text of a console menu
+ *
+ * @details    The menu is rendered into a buffer and written to the console
+ *             in one go. If the same menu is displayed again and the console
+ *             content has not been invalidated since, only the lines which
+ *             changed are rewritten using VT100 cursor addressing.
+ */
+static void adi_display_console_menu(const console_menu * menu)
+{
+	char underline[ADI_CONSOLE_MENU_LINE_LEN];
+	size_t title_len;
+	bool full_redraw;
+
+	if (menu->keyIndex != NULL && !menu->keyIndex->built) {
+		adi_console_menu_build_key_index(menu);
+	}
+
+	if (adi_console_menu_state.command_mode) {
+		return;
+	}
+
+	/*
+	 * Menu with header/footer callbacks can't be partially redrawn as the
+	 * content (and size) of the callback output is not known.
+	 */
+	full_redraw = !adi_console_menu_frame.valid ||
+		      adi_console_menu_frame.menu != menu ||
+		      menu->headerItem != NULL || menu->footerItem != NULL;
+
+	if (full_redraw) {
+		adi_clear_console();
+
+		// call headerItem to allow display of other content
+		if (menu->headerItem != NULL) {
+			adi_console_flush();
+			menu->headerItem();
+			adi_console_printf(DIV_STRING EOL);
+		}
+	}
+
+	adi_console_menu_frame.prev_lines = full_redraw ? 0 :
+					    adi_console_menu_frame.lines;
+	adi_console_menu_frame.lines = 0;
+
+	/*
+	 * Display the menu title and  menuItems
+	 * The shortcutKey is used to display '[A]' before the dispayText
+	 */
+	adi_console_menu_put_line(full_redraw, "\t%s", menu->title);
+
+	// show an underline to distinguish title from item, extended past end of string
+	title_len = strlen(menu->title) + 2;
+	if (title_len >= sizeof(underline)) {
+		title_len = sizeof(underline) - 1;
+	}
+	memset(underline, '-', title_len);
+	underline[title_len] = '\0';
+	adi_console_menu_put_line(full_redraw, "\t%s", underline);
+
+	// If the shortcutKey is not unique, first found is used
+	for (uint8_t i = 0; i < menu->itemCount; i ++) {
+		if (menu->items[i].shortcutKey == '\00') {
+			// No shortcut key defined, but display item text if available
+			adi_console_menu_put_line(full_redraw, "\t%s", menu->items[i].text);
+		} else {
+			adi_console_menu_put_line(full_redraw, "\t[%c] %s",
+						  toupper(menu->items[i].shortcutKey),
+						  menu->items[i].text);
+		}
+	}
+	if (menu->enableEscapeKey) {
+		adi_console_menu_put_line(full_redraw, "");
+		adi_console_menu_put_line(full_redraw, "\t[ESC] Exit Menu");
+	}
+
+	adi_console_menu_put_line(full_redraw, "");
+	adi_console_menu_put_line(full_redraw, "\tPlease make a selection.");
+
+	if (!full_redraw) {
+		// Park the cursor below the menu and clear any leftover output
+		adi_console_menu_append(VT100_MOVE_TO_LINE VT100_CLEAR_CURRENT_LINE,
+					ADI_CONSOLE_MENU_FIRST_LINE + adi_console_menu_frame.lines);
+	}
+
+	adi_console_menu_flush();
+
+	// call footerItem to allow display of other content
+	if (menu->footerItem != NULL) {
+		adi_console_printf(DIV_STRING EOL);
+		adi_console_flush();
+		menu->footerItem();
+	}
+
+	adi_console_menu_frame.menu = menu;
+	adi_console_menu_frame.valid = (adi_console_menu_frame.lines <=
+					ADI_CONSOLE_MENU_MAX_LINES);
+}
+
+/*!
+ * @brief      Builds the shortcut key index of a console menu
+ *
+ * @param      menu console menu
+ *
+ * @return     0 in case of success, -1 if shortcut keys are not unique
+ *
+ * @details    The index is built only once, it is called when the menu is
+ *             used for the first time but can be called by the application
+ *             at init to check the menu. Duplicate shortcut keys trigger an
+ *             assert, first item found is used otherwise.
+ */
+int32_t adi_console_menu_build_key_index(const console_menu *menu)
+{
+	console_menu_key_index *index;
+	int32_t ret = 0;
+	uint8_t key;
+
+	if (menu == NULL || menu->keyIndex == NULL) {
+		return -1;
+	}
+
+	index = menu->keyIndex;
+	if (index->built) {
+		return 0;
+	}
+
+	memset(index->item, 0, sizeof(index->item));
+
+	for (uint8_t i = 0; i < menu->itemCount; i ++) {
+		if (menu->items[i].shortcutKey == '\00') {
+			continue;
+		}
+
+		// Both cases are indexed, so key press is looked up as is
+		key = toupper((uint8_t)menu->items[i].shortcutKey);
+		if (index->item[key] != 0) {
+			// Shortcut key is not unique
+			ret = -1;
+			continue;
+		}
+
+		index->item[key] = i + 1;
+		index->item[(uint8_t)tolower(key)] = i + 1;
+	}
+
+	assert(ret == 0);
+	index->built = true;
+
+	return ret;
+}
+
+/*!
+ * @brief      Finds the menu item selected by a shortcut key
+ *
+ * @return     index of the menu item, -1 if no item uses the key
+ *
+ * @note       If the shortcutKey is not unique, first found is used
+ */
+static int16_t adi_console_menu_find_item(const console_menu *menu, char key)
+{
+	if (menu->keyIndex != NULL) {
+		if (!menu->keyIndex->built) {
+			adi_console_menu_build_key_index(menu);
+		}
+		return (int16_t)menu->keyIndex->item[(uint8_t)key] - 1;
+	}
+
+	key = toupper(key);
+
+	for (uint8_t i = 0; i < menu->itemCount; i ++) {
+		if (menu->items[i].shortcutKey != '\00' &&
+		    toupper(menu->items[i].shortcutKey) == key) {
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+/*!
+ * @brief      Displays the progress line of a long running menu action
+ */
+static void adi_console_menu_show_progress(const console_menu_job *job)
+{
+	char bar[ADI_CONSOLE_MENU_PROGRESS_WIDTH + 1];
+	uint8_t progress = (job->progress > 100) ? 100 : job->progress;
+	uint8_t filled = progress * ADI_CONSOLE_MENU_PROGRESS_WIDTH / 100;
+
+	if (adi_console_menu_state.command_mode) {
+		return;
+	}
+
+	memset(bar, '#', filled);
+	memset(&bar[filled], '.', ADI_CONSOLE_MENU_PROGRESS_WIDTH - filled);
+	bar[ADI_CONSOLE_MENU_PROGRESS_WIDTH] = '\0';
+
+	adi_console_printf("\r\t[%s] %3u%% (ESC to cancel)" VT100_CLEAR_LINE_END,
+			   bar, progress);
+}
+
+/*!
+ * @brief      Starts the job of a long running menu action
+ */
+static void adi_console_menu_job_start(console_menu_job *job,
+				       const console_menu_item *item)
+{
+	memset(job, 0, sizeof(*job));
+	job->option = item->id;
+
+	adi_console_menu_show_progress(job);
+}
+
+/*!
+ * @brief      Runs one step of a long running menu action
+ *
+ * @return     MENU_JOB_RUNNING until the job completes, the value returned by
+ *             the step action otherwise
+ *
+ * @note       Once cancelled, the step action is called one last time (with
+ *             job->cancel set) to release its resources, and the job ends
+ *             even if it returns MENU_JOB_RUNNING.
+ */
+static int32_t adi_console_menu_job_step(const console_menu_item *item,
+		console_menu_job *job)
+{
+	uint8_t progress = job->progress;
+	int32_t ret;
+
+	ret = item->stepAction(job);
+	job->step++;
+
+	if (ret == MENU_JOB_RUNNING) {
+		if (job->cancel) {
+			return MENU_CONTINUE;
+		}
+		if (job->progress != progress) {
+			adi_console_menu_show_progress(job);
+		}
+	}
+
+	return ret;
+}
+
+/*!
+ * @brief      Runs a long running menu action until it completes
+ *
+ * @return     value returned by the last step of the action
+ *
+ * @details    Used where the menu is not driven by the menu engine. The
+ *             escape key cancels the job when the console input is
+ *             non-blocking (see adi_console_rx_enable()).
+ */
+static int32_t adi_console_menu_run_job(const console_menu_item *item)
+{
+	console_menu_job job;
+	char keyPressed;
+	int32_t ret;
+
+	adi_console_menu_job_start(&job, item);
+
+	do {
+		// Console input holds the action arguments in command mode
+		while (!adi_console_menu_state.command_mode &&
+		       !adi_console_rx_pop(&keyPressed)) {
+			if (keyPressed == ESCAPE_KEY_CODE) {
+				job.cancel = true;
+			}
+		}
+		ret = adi_console_menu_job_step(item, &job);
+	} while (ret == MENU_JOB_RUNNING);
+
+	return ret;
+}
+
+/*!
+ * @brief      Leaves the current menu level of the menu engine
+ *
+ * @details    The parent menu (if any) is displayed again.
+ *
+ * @return     MENU_CONTINUE if a parent menu is still active, otherwise the
+ *             item selected/MENU_ESCAPED from the top level menu
+ */
+static int32_t adi_console_menu_leave(console_menu_engine *engine,
+				      int32_t itemSelected)
+{
+	engine->depth--;
+	if (engine->depth == 0) {
+		return itemSelected;
+	}
+
+	adi_display_console_menu(engine->stack[engine->depth - 1]);
+
+	return MENU_CONTINUE;
+}
+
+/*!
+ * @brief      Starts the menu engine with a console menu
+ *
+ * @param      engine menu engine instance
+ * @param      menu top level console menu
+ *
+ * @return     0 in case of success, -1 otherwise
+ *
+ * @details    Displays the menu. Key presses are then handled through
+ *             adi_console_menu_poll() or adi_console_menu_process_key().
+ */
+int32_t adi_console_menu_start(console_menu_engine *engine,
+			       const console_menu *menu)
+{
+	if (engine == NULL || menu == NULL) {
+		return -1;
+	}
+
+	engine->stack[0] = menu;
+	engine->depth = 1;
+	engine->jobItem = NULL;
+
+	adi_display_console_menu(menu);
+
+	return 0;
+}
+
+/*!
+ * @brief      Handles the value returned by the action of a menu item
+ *
+ * @return     MENU_CONTINUE if the menu stays active, otherwise the item
+ *             selected from the top level menu
+ */
+static int32_t adi_console_menu_action_done(console_menu_engine *engine,
+		int16_t itemSelected, int32_t ret)
+{
+	// Store the return value if it is negative.
+	if (ret < 0) {
+		adi_console_menu_state.last_error_code = ret;
+		ret = MENU_CONTINUE;
+	}
+
+	if (ret == MENU_DONE) {
+		return adi_console_menu_leave(engine, itemSelected);
+	}
+
+	adi_display_console_menu(engine->stack[engine->depth - 1]);
+
+	return MENU_CONTINUE;
+}
+
+/*!
+ * @brief      Handles a single key press for the active menu of the engine
+ *
+ * @param      engine menu engine instance
+ * @param      keyPressed key pressed by the user
+ *
+ * @return     MENU_CONTINUE while the menu is active, otherwise the item
+ *             selected/MENU_ESCAPED from the top level menu
+ *
+ * @note       Selecting an item either calls the menu action or enters the
+ *             sub menu. If both are defined, the error is stored as the last
+ *             menu error. If both are NULL, the menu is left returning the
+ *             item selected.
+ */
+int32_t adi_console_menu_process_key(console_menu_engine *engine,
+				     char keyPressed)
+{
+	const console_menu *menu;
+	const console_menu_item *item;
+	int32_t ret;
+	int16_t i;
+
+	if (engine == NULL || engine->depth == 0) {
+		return MENU_ESCAPED;
+	}
+
+	// Escape key cancels the running job, other keys are ignored
+	if (engine->jobItem != NULL) {
+		if (keyPressed == ESCAPE_KEY_CODE) {
+			engine->job.cancel = true;
+		}
+		return MENU_CONTINUE;
+	}
+
+	menu = engine->stack[engine->depth - 1];
+
+	if (menu->enableEscapeKey && keyPressed == ESCAPE_KEY_CODE) {
+		return adi_console_menu_leave(engine, MENU_ESCAPED);
+	}
+
+	i = adi_console_menu_find_item(menu, keyPressed);
+	if (i < 0) {
+		return MENU_CONTINUE;
+	}
+
+	item = &menu->items[i];
+
+	// Long running action is stepped by adi_console_menu_poll()
+	if (item->stepAction != NULL) {
+		if (item->action != NULL || item->submenu != NULL) {
+			ret = -1;
+		} else {
+			engine->jobItem = item;
+			engine->jobIndex = i;
+			adi_console_menu_job_start(&engine->job, item);
+			return MENU_CONTINUE;
+		}
+	}
+	// If the menuAction function pointer is NULL and
+	// the sub console menu pointer is not NULL,
+	// enter the sub console menu.
+	else if (item->action == NULL && item->submenu != NULL) {
+		if (engine->depth < ADI_CONSOLE_MENU_MAX_DEPTH) {
+			engine->stack[engine->depth++] = (const console_menu *)item->submenu;
+			adi_display_console_menu(engine->stack[engine->depth - 1]);
+			return MENU_CONTINUE;
+		}
+		ret = -1;
+	}
+	// If the menuAction function pointer is not NULL and sub console menu
+	// pointer is NULL, call the action.
+	else if (item->action != NULL && item->submenu == NULL) {
+		adi_console_flush();
+		ret = item->action(item->id);
+	}
+	// If both are defined, then return Not Supported action.
+	else if (item->action != NULL && item->submenu != NULL) {
+		ret = -1;
+	}
+	// If both are NULL, leave the menu returning the selected item.
+	else {
+		return adi_console_menu_leave(engine, i);
+	}
+
+	return adi_console_menu_action_done(engine, i, ret);
+}
+
+/*!
+ * @brief      Processes the console input available, without blocking
+ *
+ * @param      engine menu engine instance
+ *
+ * @return     MENU_CONTINUE while the menu is active, otherwise the item
+ *             selected/MENU_ESCAPED from the top level menu
+ *
+ * @details    Consumes the characters available into the console RX ring
+ *             buffer (see adi_console_rx_enable()) and returns as soon as no
+ *             more input is available, allowing the application to carry on
+ *             with other work (acquisition, streaming) while the menu is
+ *             displayed. Long running actions (stepAction) are run one step
+ *             per call.
+ */
+int32_t adi_console_menu_poll(console_menu_engine *engine)
+{
+	int32_t ret = MENU_CONTINUE;
+	char keyPressed;
+
+	while (ret == MENU_CONTINUE && !adi_console_rx_pop(&keyPressed)) {
+		ret = adi_console_menu_process_key(engine, keyPressed);
+	}
+
+	// Single step of the running job per call, leaving the CPU to the
+	// other tasks of the application in between
+	if (ret == MENU_CONTINUE && engine->jobItem != NULL) {
+		ret = adi_console_menu_job_step(engine->jobItem, &engine->job);
+		if (ret != MENU_JOB_RUNNING) {
+			engine->jobItem = NULL;
+			return adi_console_menu_action_done(engine, engine->jobIndex, ret);
+		}
+		ret = MENU_CONTINUE;
+	}
+
+	return ret;
+}
+
+/*!
+ * @brief      Prints the status line of a command
+ *
+ * @return     status passed in
+ */
+static int32_t adi_console_menu_cmd_status(int32_t status)
+{
+	if (status < 0) {
+		adi_console_printf("ERR %d" EOL, (int)status);
+	} else {
+		adi_console_printf("OK %d" EOL, (int)status);
+	}
+
+	return status;
+}
+
+/*!
+ * @brief      Executes a path-style menu command
+ *
+ * @param      menu top level console menu
+ * @param      command command line, e.g. "2/3/A 100"
+ *
+ * @return     index of the item selected in its menu, negative error code
+ *             otherwise
+ *
+ * @details    The command is made of the shortcut keys of the menu items to
+ *             walk through, separated by '/', optionally followed by the
+ *             arguments separated by spaces. Each argument is fed to the
+ *             menu action as a user input terminated with the return key, so
+ *             actions reading values with adi_get_decimal_int() and friends
+ *             work unchanged. A compact status line is printed: "OK <item>"
+ *             or "ERR <error code>".
+ */
+int32_t adi_console_menu_exec_command(const console_menu *menu,
+				      const char *command)
+{
+	const console_menu_item *item = NULL;
+	char args[ADI_CONSOLE_INJECT_BUF_LEN];
+	uint16_t args_len = 0;
+	int16_t indx = -1;
+	int32_t ret;
+
+	if (menu == NULL || command == NULL) {
+		return adi_console_menu_cmd_status(-1);
+	}
+
+	// Walk the path of shortcut keys
+	while (*command != '\0' && *command != ' ') {
+		if (item != NULL) {
+			// Only sub menus can be walked through
+			if (item->action != NULL || item->submenu == NULL) {
+				return adi_console_menu_cmd_status(-1);
+			}
+			menu = (const console_menu *)item->submenu;
+		}
+
+		indx = adi_console_menu_find_item(menu, *command++);
+		if (indx < 0) {
+			return adi_console_menu_cmd_status(-1);
+		}
+		item = &menu->items[indx];
+
+		if (*command == '/') {
+			command++;
+		} else if (*command != '\0' && *command != ' ') {
+			// Shortcut keys are single characters
+			return adi_console_menu_cmd_status(-1);
+		}
+	}
+
+	if (item == NULL) {
+		return adi_console_menu_cmd_status(-1);
+	}
+
+	// Item with neither action nor sub menu just reports its selection
+	if (item->action == NULL && item->submenu == NULL &&
+	    item->stepAction == NULL) {
+		return adi_console_menu_cmd_status(indx);
+	}
+
+	if ((item->action == NULL) == (item->stepAction == NULL) ||
+	    item->submenu != NULL) {
+		return adi_console_menu_cmd_status(-1);
+	}
+
+	// Each argument is terminated by the return key
+	while (*command != '\0') {
+		while (*command == ' ') {
+			command++;
+		}
+		if (*command == '\0') {
+			break;
+		}
+		while (*command != '\0' && *command != ' ' && args_len < sizeof(args) - 1) {
+			args[args_len++] = *command++;
+		}
+		if (*command != '\0' && *command != ' ') {
+			return adi_console_menu_cmd_status(-1);
+		}
+		args[args_len++] = '\r';
+	}
+
+	if (adi_console_inject_input(args, args_len)) {
+		return adi_console_menu_cmd_status(-1);
+	}
+
+	adi_console_flush();
+	if (item->stepAction != NULL) {
+		ret = adi_console_menu_run_job(item);
+	} else {
+		ret = item->action(item->id);
+	}
+	adi_console_clear_injected_input();
+
+	if (ret < 0) {
+		adi_console_menu_state.last_error_code = ret;
+		return adi_console_menu_cmd_status(ret);
+	}
+
+	return adi_console_menu_cmd_status(indx);
+}
+
+/*!
+ * @brief      Drives a console menu with path-style commands
  *
- * @details
+ * @param      menu top level console menu
+ *
+ * @return     MENU_ESCAPED once command mode is left
+ *
+ * @details    Reads command lines (see adi_console_menu_exec_command())
+ *             without echo and without displaying the menus, and answers each
+ *             of them with a single status line. This is meant for automated
+ *             test stations driving the firmware. Command mode is left with
+ *             the "exit" command or the escape key.
  */
-static void adi_display_console_menu(const console_menu * menu)
+int32_t adi_do_console_menu_command_mode(const console_menu *menu)
 {
-	adi_clear_console();
+	char line[ADI_CONSOLE_MENU_CMD_MAX_LEN];
+	uint8_t len = 0;
+	bool overflow = false;
+	char ch;
 
-	// call headerItem to allow display of other content
-	if (menu->headerItem != NULL) {
-		menu->headerItem();
-		printf(DIV_STRING EOL);
-	}
+	adi_console_menu_state.command_mode = true;
 
-	/*
-	 * Display the menu title and  menuItems
-	 * The shortcutKey is used to display '[A]' before the dispayText
-	 */
-	printf("\t%s" EOL "\t", menu->title);
-	// show an underline to distinguish title from item
-	for (uint8_t i = 0; i < strlen(menu->title); i++) {
-		putchar('-');
-	}
-	// Extend underline past end of string, and then new line
-	printf("--" EOL);
+	while (true) {
+		ch = adi_console_getchar();
 
-	// If the shortcutKey is not unique, first found is used
-	for (uint8_t i = 0; i < menu->itemCount; i ++) {
-		if (menu->items[i].shortcutKey == '\00') {
-			// No shortcut key defined, but display item text if available
-			printf("\t%s" EOL, menu->items[i].text);
+		if (ch == ESCAPE_KEY_CODE) {
+			break;
+		}
+
+		if ((ch == '\x0D') || (ch == '\x0A')) {
+			line[len] = '\x00';
+			if (!strcmp(line, "exit")) {
+				break;
+			}
+			if (overflow) {
+				adi_console_menu_cmd_status(-1);
+			} else if (len > 0) {
+				adi_console_menu_exec_command(menu, line);
+			}
+			len = 0;
+			overflow = false;
+		} else if (len < sizeof(line) - 1) {
+			line[len++] = ch;
 		} else {
-			printf("\t[%c] %s" EOL, toupper(menu->items[i].shortcutKey),
-			       menu->items[i].text);
+			overflow = true;
 		}
 	}
-	if (menu->enableEscapeKey) {
-		printf(EOL "\t[ESC] Exit Menu" EOL);
-	}
 
-	printf(EOL "\tPlease make a selection." EOL);
+	adi_console_menu_state.command_mode = false;
+	adi_console_menu_invalidate();
 
-	// call footerItem to allow display of other content
-	if (menu->footerItem != NULL) {
-		printf(DIV_STRING EOL);
-		menu->footerItem();
-	}
+	return MENU_ESCAPED;
 }
 
 /*!
@@ -110,82 +862,517 @@ static void adi_display_console_menu(const console_menu * menu)
  */
 int32_t adi_do_console_menu(const console_menu * menu)
 {
-	int32_t itemSelected = MENU_ESCAPED;
-	bool enableKeyScan = true;
-	int32_t ret = MENU_DONE;
+	console_menu_engine engine;
+	int32_t ret;
 
-	adi_display_console_menu(menu);
+	if (adi_console_menu_start(&engine, menu)) {
+		return MENU_ESCAPED;
+	}
 
 	/*
 	 *  Loop waiting for valid user input. menuItem index is returned if
 	 *  user presses a valid menu option.
 	 */
 	do {
-		char keyPressed = toupper(getchar());
+		if (engine.jobItem != NULL) {
+			ret = adi_console_menu_poll(&engine);
+		} else {
+			ret = adi_console_menu_process_key(&engine, adi_console_getchar());
+		}
+	} while (ret == MENU_CONTINUE);
 
-		if (menu->enableEscapeKey) {
-			if (keyPressed == ESCAPE_KEY_CODE) {
-				itemSelected = MENU_ESCAPED;
-				enableKeyScan = false;
-				break;
-			}
+	return ret;
+}
+
+/*!
+ * @brief      Reads the current value of a dashboard slot
+ */
+static void adi_console_dashboard_get_value(const console_dashboard_slot *slot,
+		char *value)
+{
+	value[0] = '\0';
+	slot->getValue(value, ADI_CONSOLE_DASHBOARD_VALUE_LEN, slot->id);
+	value[ADI_CONSOLE_DASHBOARD_VALUE_LEN - 1] = '\0';
+}
+
+/*!
+ * @brief      Displays the complete dashboard
+ */
+static void adi_console_dashboard_draw(void)
+{
+	const console_dashboard *dashboard = adi_console_dashboard_frame.dashboard;
+	const console_menu *menu = dashboard->menu;
+	char underline[ADI_CONSOLE_MENU_LINE_LEN];
+	size_t label_width = 0;
+	size_t title_len;
+	uint16_t lines;
+
+	adi_clear_console();
+
+	for (uint8_t i = 0; i < dashboard->slotCount; i ++) {
+		if (strlen(dashboard->slots[i].label) > label_width) {
+			label_width = strlen(dashboard->slots[i].label);
 		}
+	}
+	// Values are displayed after "label : "
+	adi_console_dashboard_frame.value_col = ADI_CONSOLE_DASHBOARD_LABEL_COL +
+						label_width + 3;
+
+	adi_console_menu_append("\t%s" EOL, dashboard->title);
+
+	title_len = strlen(dashboard->title) + 2;
+	if (title_len >= sizeof(underline)) {
+		title_len = sizeof(underline) - 1;
+	}
+	memset(underline, '-', title_len);
+	underline[title_len] = '\0';
+	adi_console_menu_append("\t%s" EOL, underline);
+	lines = 2;
+
+	for (uint8_t i = 0; i < dashboard->slotCount; i ++) {
+		adi_console_dashboard_get_value(&dashboard->slots[i],
+						adi_console_dashboard_frame.value[i]);
+		adi_console_menu_append("\t%-*s : %s" EOL, (int)label_width,
+					dashboard->slots[i].label,
+					adi_console_dashboard_frame.value[i]);
+		lines++;
+	}
 
+	if (menu != NULL) {
+		adi_console_menu_append(EOL);
+		lines++;
 		for (uint8_t i = 0; i < menu->itemCount; i ++) {
-			if (toupper(menu->items[i].shortcutKey) == keyPressed) {
-				itemSelected = i;
-
-				// If the menuAction function pointer is NULL and
-				// the sub console menu pointer is not NULL,
-				// call the sub console menu.
-				if (menu->items[i].action == NULL
-				    && menu->items[i].submenu != NULL) {
-					ret = adi_do_console_menu(menu->items[i].submenu);
-				}
-				// If the menuAction function pointer is not NULL and sub console menu
-				// pointer is NULL, call the action.
-				else if (menu->items[i].action != NULL && menu->items[i].submenu == NULL) {
-					ret = menu->items[i].action(menu->items[i].id);
-				}
-				// If both are NULL, then return Not Supported action.
-				else if (menu->items[i].action != NULL && menu->items[i].submenu != NULL) {
-					ret = -1;
-				}
-
-				// Store the return value if it is negative.
-				if (ret < 0) {
-					adi_console_menu_state.last_error_code = ret;
-					ret = MENU_CONTINUE;
-				}
-
-				switch (ret) {
-				case MENU_DONE : {
-					enableKeyScan = false;
-					break;
-				}
-				case MENU_CONTINUE:
-				default: {
-					enableKeyScan = true;
-					adi_display_console_menu(menu);
-					break;
-					}
-				}
+			if (menu->items[i].shortcutKey == '\00') {
+				adi_console_menu_append("\t%s" EOL, menu->items[i].text);
+			} else {
+				adi_console_menu_append("\t[%c] %s" EOL,
+							toupper(menu->items[i].shortcutKey),
+							menu->items[i].text);
+			}
+			lines++;
+		}
+	}
+	if (dashboard->enableEscapeKey) {
+		adi_console_menu_append(EOL "\t[ESC] Exit Dashboard" EOL);
+		lines += 2;
+	}
 
-				break;
+	adi_console_menu_flush();
+
+	adi_console_dashboard_frame.prompt_line = ADI_CONSOLE_MENU_FIRST_LINE + lines;
+	adi_console_dashboard_frame.valid = true;
+}
+
+/*!
+ * @brief      Rewrites the characters of a dashboard value which changed
+ *
+ * @return     true if anything has been written to the console
+ *
+ * @details    Each run of changed characters is written after a VT100 cursor
+ *             move. Runs separated by only a few unchanged characters are
+ *             merged, as rewriting these is cheaper than moving the cursor.
+ */
+static bool adi_console_dashboard_put_diff(uint16_t line, const char *prev,
+		const char *value)
+{
+	uint16_t prev_len = strlen(prev);
+	uint16_t len = strlen(value);
+	uint16_t start;
+	uint16_t end;
+	uint16_t i = 0;
+	bool changed = false;
+
+	while (i < len) {
+		if (i < prev_len && prev[i] == value[i]) {
+			i++;
+			continue;
+		}
+
+		start = i;
+		end = i + 1;
+		for (i = end; i < len && i < end + ADI_CONSOLE_DASHBOARD_MIN_GAP; i++) {
+			if (i >= prev_len || prev[i] != value[i]) {
+				end = i + 1;
 			}
 		}
+		i = end;
 
-		// If both the action and sub menu are defined NULL, and the item selected
-		// is not MENU_ESCAPED, then break the loop to return selected item.
-		if(itemSelected != MENU_ESCAPED &&
-		    menu->items[itemSelected].action == NULL &&
-		    menu->items[itemSelected].submenu == NULL) {
-			break;
+		adi_console_menu_append(VT100_MOVE_TO "%.*s", line,
+					adi_console_dashboard_frame.value_col + start,
+					end - start, &value[start]);
+		changed = true;
+	}
+
+	// Erase the remaining characters of a longer previous value
+	if (prev_len > len) {
+		adi_console_menu_append(VT100_MOVE_TO VT100_CLEAR_LINE_END, line,
+					adi_console_dashboard_frame.value_col + len);
+		changed = true;
+	}
+
+	return changed;
+}
+
+/*!
+ * @brief      Refreshes the dashboard values which changed
+ */
+static void adi_console_dashboard_refresh(void)
+{
+	const console_dashboard *dashboard = adi_console_dashboard_frame.dashboard;
+	char value[ADI_CONSOLE_DASHBOARD_VALUE_LEN];
+	bool changed = false;
+
+	for (uint8_t i = 0; i < dashboard->slotCount; i ++) {
+		adi_console_dashboard_get_value(&dashboard->slots[i], value);
+		if (adi_console_dashboard_put_diff(ADI_CONSOLE_MENU_FIRST_LINE + 2 + i,
+						   adi_console_dashboard_frame.value[i], value)) {
+			strcpy(adi_console_dashboard_frame.value[i], value);
+			changed = true;
+		}
+	}
+
+	if (changed) {
+		// Park the cursor back below the dashboard
+		adi_console_menu_append(VT100_MOVE_TO_LINE,
+					adi_console_dashboard_frame.prompt_line);
+		adi_console_menu_flush();
+	}
+}
+
+/*!
+ * @brief      Handles a single key press for the dashboard
+ *
+ * @return     MENU_CONTINUE while the dashboard is active, otherwise the item
+ *             selected/MENU_ESCAPED
+ *
+ * @details    Items of the dashboard menu are handled as in
+ *             adi_console_menu_process_key(), except long running actions
+ *             which are run to completion (values are not refreshed meanwhile).
+ */
+static int32_t adi_console_dashboard_process_key(const console_dashboard
+		*dashboard, char keyPressed)
+{
+	const console_menu_item *item;
+	int32_t ret;
+	int16_t i;
+
+	if (dashboard->enableEscapeKey && keyPressed == ESCAPE_KEY_CODE) {
+		return MENU_ESCAPED;
+	}
+
+	if (dashboard->menu == NULL) {
+		return MENU_CONTINUE;
+	}
+
+	i = adi_console_menu_find_item(dashboard->menu, keyPressed);
+	if (i < 0) {
+		return MENU_CONTINUE;
+	}
+
+	item = &dashboard->menu->items[i];
+
+	if (item->stepAction != NULL) {
+		if (item->action != NULL || item->submenu != NULL) {
+			ret = -1;
+		} else {
+			adi_console_flush();
+			ret = adi_console_menu_run_job(item);
+		}
+	} else if (item->action == NULL && item->submenu != NULL) {
+		adi_console_menu_start(&adi_console_dashboard_frame.submenu,
+				       (const console_menu *)item->submenu);
+		return MENU_CONTINUE;
+	} else if (item->action != NULL && item->submenu == NULL) {
+		adi_console_flush();
+		ret = item->action(item->id);
+	} else if (item->action != NULL && item->submenu != NULL) {
+		ret = -1;
+	} else {
+		return i;
+	}
+
+	if (ret < 0) {
+		adi_console_menu_state.last_error_code = ret;
+		ret = MENU_CONTINUE;
+	}
+
+	if (ret == MENU_DONE) {
+		return i;
+	}
+
+	if (adi_console_dashboard_frame.valid) {
+		// Clear any output left by the action below the dashboard
+		adi_console_menu_append(VT100_MOVE_TO_LINE VT100_CLEAR_CURRENT_LINE,
+					adi_console_dashboard_frame.prompt_line);
+		adi_console_menu_flush();
+	}
+
+	return MENU_CONTINUE;
+}
+
+/*!
+ * @brief      Starts displaying a dashboard
+ *
+ * @param      dashboard console dashboard
+ *
+ * @return     0 in case of success, -1 otherwise
+ *
+ * @details    The dashboard is then refreshed and its key presses handled
+ *             through adi_console_dashboard_poll().
+ */
+int32_t adi_console_dashboard_start(const console_dashboard *dashboard)
+{
+	if (dashboard == NULL ||
+	    dashboard->slotCount > ADI_CONSOLE_DASHBOARD_MAX_SLOTS) {
+		return -1;
+	}
+
+	for (uint8_t i = 0; i < dashboard->slotCount; i ++) {
+		if (dashboard->slots[i].getValue == NULL) {
+			return -1;
+		}
+	}
+
+	adi_console_dashboard_frame.dashboard = dashboard;
+	adi_console_dashboard_frame.submenu.depth = 0;
+	adi_console_dashboard_draw();
+	if (dashboard->getTimeMs != NULL) {
+		adi_console_dashboard_frame.last_refresh_ms = dashboard->getTimeMs();
+	}
+
+	return 0;
+}
+
+/*!
+ * @brief      Processes the console input available and refreshes the
+ *             dashboard values, without blocking
+ *
+ * @param      dashboard console dashboard started by adi_console_dashboard_start()
+ *
+ * @return     MENU_CONTINUE while the dashboard is active, otherwise the item
+ *             selected/MENU_ESCAPED
+ *
+ * @details    Values are refreshed at most once per refreshPeriodMs, and only
+ *             the characters which changed are rewritten onto the console.
+ */
+int32_t adi_console_dashboard_poll(const console_dashboard *dashboard)
+{
+	int32_t ret = MENU_CONTINUE;
+	uint32_t now;
+	char keyPressed;
+
+	if (dashboard == NULL ||
+	    adi_console_dashboard_frame.dashboard != dashboard) {
+		return MENU_ESCAPED;
+	}
+
+	// Dashboard is hidden by the sub menu until it is left
+	if (adi_console_dashboard_frame.submenu.depth > 0) {
+		if (adi_console_menu_poll(&adi_console_dashboard_frame.submenu) !=
+		    MENU_CONTINUE) {
+			adi_console_dashboard_frame.submenu.depth = 0;
+			adi_console_dashboard_frame.valid = false;
+		}
+		return MENU_CONTINUE;
+	}
+
+	while (ret == MENU_CONTINUE &&
+	       adi_console_dashboard_frame.submenu.depth == 0 &&
+	       !adi_console_rx_pop(&keyPressed)) {
+		ret = adi_console_dashboard_process_key(dashboard, keyPressed);
+	}
+
+	if (ret != MENU_CONTINUE) {
+		adi_console_dashboard_frame.dashboard = NULL;
+		return ret;
+	}
+
+	if (adi_console_dashboard_frame.submenu.depth > 0) {
+		return MENU_CONTINUE;
+	}
+
+	if (!adi_console_dashboard_frame.valid) {
+		adi_console_dashboard_draw();
+		return MENU_CONTINUE;
+	}
+
+	if (dashboard->getTimeMs != NULL) {
+		now = dashboard->getTimeMs();
+		if (now - adi_console_dashboard_frame.last_refresh_ms <
+		    dashboard->refreshPeriodMs) {
+			return MENU_CONTINUE;
+		}
+		adi_console_dashboard_frame.last_refresh_ms = now;
+	}
+
+	adi_console_dashboard_refresh();
+
+	return MENU_CONTINUE;
+}
+
+/*!
+ * @brief      Displays a dashboard until it is left
+ *
+ * @param      dashboard console dashboard
+ *
+ * @return     the item selected/MENU_ESCAPED
+ *
+ * @note       Console input must be non-blocking (see adi_console_rx_enable())
+ *             for the values to be refreshed while waiting for key presses.
+ */
+int32_t adi_do_console_dashboard(const console_dashboard *dashboard)
+{
+	int32_t ret;
+
+	if (!adi_console_rx_is_enabled() || adi_console_dashboard_start(dashboard)) {
+		return MENU_ESCAPED;
+	}
+
+	do {
+		ret = adi_console_dashboard_poll(dashboard);
+	} while (ret == MENU_CONTINUE);
+
+	return ret;
+}
+
+/*!
+ * @brief      Starts reading a number from the user
+ *
+ * @param      input number input instance
+ * @param      type type of number to be read
+ * @param      input_len max number of character to accept from the user
+ *
+ * @details    Characters are then fed through adi_console_input_feed() or
+ *             adi_console_input_poll().
+ */
+void adi_console_input_start(console_input *input,
+			     enum console_input_type type,
+			     uint8_t input_len)
+{
+	assert(input_len < sizeof(input->buf) - 1);
+	assert(type != CONSOLE_INPUT_HEX_INT || input_len < 8);
+
+	input->type = type;
+	input->max_len = input_len;
+	input->len = 0;
+	input->buf[0] = '\x00';
+	input->done = false;
+
+	// User input is echoed onto the console below the menu
+	adi_console_menu_invalidate();
+}
+
+/*!
+ * @brief      Feeds a character typed by the user to the number input
+ *
+ * @param      input number input instance
+ * @param      ch character typed
+ *
+ * @return     true once the return key has been pressed, false otherwise
+ *
+ * @details    Valid characters are echoed back to the user, up to input_len
+ *             chars. Backspace removes the last character.
+ */
+bool adi_console_input_feed(console_input *input, char ch)
+{
+	bool valid;
+
+	switch (input->type) {
+	case CONSOLE_INPUT_HEX_INT:
+		valid = isxdigit(ch);
+		break;
+	case CONSOLE_INPUT_DECIMAL_FLOAT:
+		valid = isdigit(ch) || (ch == '.');
+		break;
+	case CONSOLE_INPUT_DECIMAL_INT:
+	default:
+		valid = isdigit(ch);
+		break;
+	}
+
+	if (valid && input->len < input->max_len) {
+		//  echo and store it as buf not full
+		input->buf[input->len++] = ch;
+		if (!adi_console_menu_state.command_mode) {
+			adi_console_putchar(ch);
+		}
+	}
+	if ((ch == '\x7F') && (input->len > 0)) {
+		//backspace and at least 1 char in buffer
+		input->buf[--input->len] = '\x00';
+		if (!adi_console_menu_state.command_mode) {
+			adi_console_putchar(ch);
 		}
+	}
+	if ((ch == '\x0D') || (ch == '\x0A')) {
+		// return key pressed, all done, null terminate string
+		input->buf[input->len] = '\x00';
+		input->done = true;
+	}
+
+	return input->done;
+}
+
+/*!
+ * @brief      Processes the console input available for the number input,
+ *             without blocking
+ *
+ * @param      input number input instance
+ *
+ * @return     true once the number has been entered, false otherwise
+ */
+bool adi_console_input_poll(console_input *input)
+{
+	char ch;
+
+	while (!input->done && !adi_console_rx_pop(&ch)) {
+		adi_console_input_feed(input, ch);
+	}
+
+	return input->done;
+}
+
+/*!
+ * @brief      Reads the number entered as integer
+ *
+ * @param      input number input instance
+ *
+ * @return     The integer value entered
+ */
+int32_t adi_console_input_get_int(const console_input *input)
+{
+	if (input->type == CONSOLE_INPUT_HEX_INT) {
+		return strtol(input->buf, NULL, 16);
+	}
+
+	return atoi(input->buf);
+}
+
+/*!
+ * @brief      Reads the number entered as float
+ *
+ * @param      input number input instance
+ *
+ * @return     The float value entered
+ */
+float adi_console_input_get_float(const console_input *input)
+{
+	return atof(input->buf);
+}
+
+/*!
+ * @brief      Reads a number from the user, waiting for the return key
+ */
+static void adi_console_input_read(console_input *input,
+				   enum console_input_type type,
+				   uint8_t input_len)
+{
+	adi_console_input_start(input, type, input_len);
 
-	} while (enableKeyScan);
+	while (!adi_console_input_feed(input, adi_console_getchar())) ;
 
-	return (itemSelected);
+	// Echo is sent out before returning to the caller, which may print
+	adi_console_flush();
 }
 
 /*!
@@ -202,33 +1389,11 @@ int32_t adi_do_console_menu(const console_menu * menu)
  */
 int32_t adi_get_decimal_int(uint8_t input_len)
 {
-	char buf[20] = {0};
-	uint8_t buf_index = 0;
-	char ch;
-	bool loop = true;
+	console_input input;
 
-	assert(input_len < 19);
-
-	do  {
-		ch = getchar();
-		if (isdigit(ch) && buf_index < (input_len)) {
-			//  echo and store it as buf not full
-			buf[buf_index++] = ch;
-			putchar(ch);
-		}
-		if ((ch == '\x7F') && (buf_index > 0)) {
-			//backspace and at least 1 char in buffer
-			buf[buf_index--] = '\x00';
-			putchar(ch);
-		}
-		if ((ch == '\x0D') || (ch == '\x0A')) {
-			// return key pressed, all done, null terminate string
-			buf[buf_index] = '\x00';
-			loop = false;
-		}
-	} while(loop);
+	adi_console_input_read(&input, CONSOLE_INPUT_DECIMAL_INT, input_len);
 
-	return atoi(buf);
+	return adi_console_input_get_int(&input);
 }
 
 /*!
@@ -243,33 +1408,11 @@ int32_t adi_get_decimal_int(uint8_t input_len)
  */
 uint32_t adi_get_hex_integer(uint8_t input_len)
 {
-	char buf[9] = {0};
-	uint8_t buf_index = 0;
-	char ch;
-	bool loop = true;
+	console_input input;
 
-	assert(input_len < 8);
-
-	do  {
-		ch = getchar();
-		if (isxdigit(ch) && buf_index < (input_len)) {
-			//  echo and store it as buf not full
-			buf[buf_index++] = ch;
-			putchar(ch);
-		}
-		if ((ch == '\x7F') && (buf_index > 0)) {
-			//backspace and at least 1 char in buffer
-			buf[buf_index--] = '\x00';
-			putchar(ch);
-		}
-		if ((ch == '\x0D') || (ch == '\x0A')) {
-			// return key pressed, all done, null terminate string
-			buf[buf_index] = '\x00';
-			loop = false;
-		}
-	} while(loop);
+	adi_console_input_read(&input, CONSOLE_INPUT_HEX_INT, input_len);
 
-	return strtol(buf, NULL, 16);
+	return adi_console_input_get_int(&input);
 }
 
 /*!
@@ -286,33 +1429,11 @@ uint32_t adi_get_hex_integer(uint8_t input_len)
  */
 float adi_get_decimal_float(uint8_t input_len)
 {
-	char buf[20] = { 0 };
-	uint8_t buf_index = 0;
-	char ch;
-	bool loop = true;
+	console_input input;
 
-	assert(input_len < 19);
+	adi_console_input_read(&input, CONSOLE_INPUT_DECIMAL_FLOAT, input_len);
 
-	do {
-		ch = getchar();
-		if ((isdigit(ch) || (ch == '.')) && buf_index < (input_len)) {
-			//  echo and store it as buf not full
-			buf[buf_index++] = ch;
-			putchar(ch);
-		}
-		if ((ch == '\x7F') && (buf_index > 0)) {
-			//backspace and at least 1 char in buffer
-			buf[buf_index--] = '\x00';
-			putchar(ch);
-		}
-		if ((ch == '\x0D') || (ch == '\x0A')) {
-			// return key pressed, all done, null terminate string
-			buf[buf_index] = '\x00';
-			loop = false;
-		}
-	} while (loop);
-
-	return atof(buf);
+	return adi_console_input_get_float(&input);
 }
 
 /**
@@ -346,7 +1467,7 @@ int32_t adi_handle_user_input_integer(const char* menu_prompt,
 	do {
 		/* Gets the input from the user and allows
 		 * reattempts in-case of incorrect input */
-		printf("%s (%d - %d): ", menu_prompt, min_val, max_val);
+		adi_console_printf("%s (%d - %d): ", menu_prompt, min_val, max_val);
 		*input_val = (uint16_t)adi_get_decimal_int(input_len);
 
 		if ((*input_val >= min_val) && (*input_val <= max_val)) {
@@ -354,18 +1475,18 @@ int32_t adi_handle_user_input_integer(const char* menu_prompt,
 			break;
 		} else {
 			if (count == max_attempts) {
-				printf(EOL "Maximum try limit exceeded" EOL);
+				adi_console_printf(EOL "Maximum try limit exceeded" EOL);
 				adi_press_any_key_to_continue();
 				return -1;
 			}
 
-			printf(EOL "Please enter a valid selection" EOL);
+			adi_console_printf(EOL "Please enter a valid selection" EOL);
 			adi_press_any_key_to_continue();
 			/* Moves up the cursor by specified lines and
 			 * clears the lines below it */
 			for (uint8_t i = 0; i < clear_lines; i++) {
-				printf(VT100_CLEAR_CURRENT_LINE);
-				printf(VT100_MOVE_UP_N_LINES, 1);
+				adi_console_printf(VT100_CLEAR_CURRENT_LINE);
+				adi_console_printf(VT100_MOVE_UP_N_LINES, 1);
 			}
 		}
 	} while (++count <= max_attempts);
@@ -404,7 +1525,7 @@ int32_t adi_handle_user_input_float(const char* menu_prompt,
 	do {
 		/* Gets the input from the user and allows
 		 * reattempts in-case of incorrect input */
-		printf("%s (%0.3f - %0.3f): ", menu_prompt, min_val, max_val);
+		adi_console_printf("%s (%0.3f - %0.3f): ", menu_prompt, min_val, max_val);
 		*input_val = adi_get_decimal_float(input_len);
 
 		if ((*input_val >= min_val) && (*input_val <= max_val)) {
@@ -413,18 +1534,18 @@ int32_t adi_handle_user_input_float(const char* menu_prompt,
 		}
 		else {
 			if (count == max_attempts) {
-				printf(EOL "Maximum try limit exceeded" EOL);
+				adi_console_printf(EOL "Maximum try limit exceeded" EOL);
 				adi_press_any_key_to_continue();
 				return -1;
 			}
 
-			printf(EOL "Please enter a valid selection" EOL);
+			adi_console_printf(EOL "Please enter a valid selection" EOL);
 			adi_press_any_key_to_continue();
 			/* Moves up the cursor by specified lines and
 			 * clears the lines below it */
 			for (uint8_t i = 0; i < clear_lines; i++) {
-				printf(VT100_CLEAR_CURRENT_LINE);
-				printf(VT100_MOVE_UP_N_LINES, 1);
+				adi_console_printf(VT100_CLEAR_CURRENT_LINE);
+				adi_console_printf(VT100_MOVE_UP_N_LINES, 1);
 			}
 		}
 	} while (++count <= max_attempts);
@@ -445,13 +1566,32 @@ void adi_clear_console(void)
 	 *  Dedicated call to move home is because sometimes first move home doesn't work
 	 *  \r\n required to flush the uart buffer.
 	 */
-	printf(VT100_CLEAR_CONSOLE VT100_MOVE_TO_HOME EOL);
+	if (adi_console_menu_state.command_mode) {
+		return;
+	}
+
+	adi_console_printf(VT100_CLEAR_CONSOLE VT100_MOVE_TO_HOME EOL);
+	adi_console_menu_invalidate();
 
    /*
 	* if VT100 is not supported, this can be enabled instead, but menu display may not work well
 	*/
 //    for (uint8_t = 0; i < 100; i++)
-//      printf("\r\n\r");
+//      adi_console_printf("\r\n\r");
+}
+
+/*!
+ * @brief      Invalidates the menu frame displayed onto the console
+ *
+ * @details    Forces the next menu (or dashboard) display to redraw it
+ *             completely. Menu actions which write to the console (other than
+ *             through the library functions) and may scroll the menu out of
+ *             its position should call this before returning MENU_CONTINUE.
+ */
+void adi_console_menu_invalidate(void)
+{
+	adi_console_menu_frame.valid = false;
+	adi_console_dashboard_frame.valid = false;
 }
 
 /*!
@@ -481,6 +1621,13 @@ int32_t adi_get_last_menu_error(void)
  */
 void adi_press_any_key_to_continue(void)
 {
-	printf("\r\nPress any key to continue...\r\n");
-	getchar();
+	// Nobody to press a key in command mode
+	if (adi_console_menu_state.command_mode) {
+		return;
+	}
+
+	adi_console_menu_invalidate();
+	adi_console_printf("\r\nPress any key to continue...\r\n");
+	adi_console_getchar();
+	adi_console_flush();
 }
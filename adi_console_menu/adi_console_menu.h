@@ -25,6 +25,8 @@
 #include <stdint.h>
 #include <limits.h>
 
+#include "adi_console_io.h"
+
 /******************************************************************************/
 /********************** Macros and Constants Definition ***********************/
 /******************************************************************************/
@@ -32,6 +34,7 @@
 #define MENU_ESCAPED          INT_MAX
 #define MENU_CONTINUE         INT_MAX-1
 #define MENU_DONE             INT_MAX-2
+#define MENU_JOB_RUNNING      INT_MAX-3
 
 #define ESCAPE_KEY_CODE         (char)0x1B
 
@@ -44,6 +47,48 @@
 #define VT100_CLEAR_CONSOLE         "\x1B[2J"
 #define VT100_MOVE_TO_HOME          "\x1B[H"
 #define VT100_COLORED_TEXT          "\x1B[%dm"
+#define VT100_MOVE_TO_LINE          "\x1B[%d;1H"
+#define VT100_CLEAR_LINE_END        "\x1B[K"
+#define VT100_MOVE_TO               "\x1B[%d;%dH"
+
+/* Size of the buffer used to render a menu before writing it to console */
+#ifndef ADI_CONSOLE_MENU_OUT_BUF_LEN
+#define ADI_CONSOLE_MENU_OUT_BUF_LEN    512
+#endif
+
+/* Max length of a single rendered menu line */
+#ifndef ADI_CONSOLE_MENU_LINE_LEN
+#define ADI_CONSOLE_MENU_LINE_LEN       128
+#endif
+
+/* Max length of a command line in command mode */
+#ifndef ADI_CONSOLE_MENU_CMD_MAX_LEN
+#define ADI_CONSOLE_MENU_CMD_MAX_LEN    64
+#endif
+
+/* Max nesting level of sub menus */
+#ifndef ADI_CONSOLE_MENU_MAX_DEPTH
+#define ADI_CONSOLE_MENU_MAX_DEPTH      8
+#endif
+
+/* Max number of menu lines tracked for partial (diff) redraw */
+#ifndef ADI_CONSOLE_MENU_MAX_LINES
+#define ADI_CONSOLE_MENU_MAX_LINES      48
+#endif
+
+/* Max number of live value slots of a console dashboard */
+#ifndef ADI_CONSOLE_DASHBOARD_MAX_SLOTS
+#define ADI_CONSOLE_DASHBOARD_MAX_SLOTS 16
+#endif
+
+/* Max length of a dashboard value, including the null terminator */
+#ifndef ADI_CONSOLE_DASHBOARD_VALUE_LEN
+#define ADI_CONSOLE_DASHBOARD_VALUE_LEN 24
+#endif
+
+/* Defines the storage of the shortcut key index of a console menu.
+ * The index is built once, when the menu is used for the first time */
+#define CONSOLE_MENU_KEY_INDEX(name)    static console_menu_key_index name
 
 #ifndef ARRAY_SIZE
 #define ARRAY_SIZE(x) ((sizeof (x)) / (sizeof ((x)[0])))
@@ -68,9 +113,33 @@ enum vt100_colors {
 typedef struct {
 	// Stores the error code from the last menu action.
 	int32_t last_error_code;
+	// Menus are driven by path-style commands, nothing is displayed.
+	bool command_mode;
 } console_menu_state;
 
 /* Type Definitions */
+// Shortcut key to menu item lookup table
+typedef struct {
+	// Table has been built from the menu items
+	bool built;
+	// Menu item index + 1 for each key value, 0 if no item uses the key
+	uint8_t item[UCHAR_MAX + 1];
+} console_menu_key_index;
+
+// State of a long running menu action, stepped by the menu loop
+typedef struct {
+	// id value of the menu item
+	uint32_t option;
+	// Number of steps already run
+	uint32_t step;
+	// Progress of the job in percent, updated by the step action
+	uint8_t progress;
+	// Job has been cancelled, this is the last call of the step action
+	bool cancel;
+	// Data kept by the step action between two steps
+	void *priv;
+} console_menu_job;
+
 // Each menu item is defined by this struct
 typedef struct {
 	// String displayed for menu item
@@ -83,6 +152,9 @@ typedef struct {
 	struct console_menu *submenu;
 	// id value passed as the option value when calling menuAction
 	uint32_t id;
+	// Long running action, called once per step of the menu loop for as long
+	// as it returns MENU_JOB_RUNNING. Used only if action and submenu are NULL
+	int32_t (*stepAction)(console_menu_job *job);
 } console_menu_item;
 
 // This defines a complete menu with items
@@ -99,12 +171,99 @@ typedef struct {
 	void (*footerItem)(void);
 	// Should the escape key to exit the menu be enabled?
 	bool enableEscapeKey;
+	// Shortcut key index for constant time key lookup, if NULL the items
+	// are searched linearly (see CONSOLE_MENU_KEY_INDEX)
+	console_menu_key_index *keyIndex;
 } console_menu;
 
+// Menu engine, handles the menu navigation one key press at a time
+typedef struct {
+	// Stack of the active menu and its parent menus
+	const console_menu *stack[ADI_CONSOLE_MENU_MAX_DEPTH];
+	// Number of menus on the stack
+	uint8_t depth;
+	// Menu item whose step action is running, NULL if none
+	const console_menu_item *jobItem;
+	// Index of the menu item whose step action is running
+	int16_t jobIndex;
+	// Job of the running step action
+	console_menu_job job;
+} console_menu_engine;
+
+// Live value displayed by a console dashboard
+typedef struct {
+	// String displayed before the value
+	char * label;
+	// Function formatting the current value into buf (len bytes long)
+	void (*getValue)(char *buf, uint8_t len, uint32_t id);
+	// id value passed when calling getValue
+	uint32_t id;
+} console_dashboard_slot;
+
+// This defines a dashboard, a screen of live values refreshed periodically
+typedef struct {
+	// String to be displayed as the dashboard title
+	char * title;
+	// Array of all the live values
+	console_dashboard_slot * slots;
+	// Number of slots
+	uint8_t slotCount;
+	// Menu whose items can be selected while the dashboard is displayed,
+	// if NULL, only the escape key is handled
+	const console_menu *menu;
+	// Min time between two refreshes of the values, in milliseconds
+	uint32_t refreshPeriodMs;
+	// Function returning the current time in milliseconds, if NULL the
+	// values are refreshed every time the dashboard is polled
+	uint32_t (*getTimeMs)(void);
+	// Should the escape key to exit the dashboard be enabled?
+	bool enableEscapeKey;
+} console_dashboard;
+
+// Type of number read from the user
+enum console_input_type {
+	CONSOLE_INPUT_DECIMAL_INT,
+	CONSOLE_INPUT_HEX_INT,
+	CONSOLE_INPUT_DECIMAL_FLOAT
+};
+
+// Number input, handles the number entry one character at a time
+typedef struct {
+	// Type of number read
+	enum console_input_type type;
+	// Characters entered
+	char buf[20];
+	// Number of characters entered
+	uint8_t len;
+	// Max number of characters accepted
+	uint8_t max_len;
+	// Return key has been pressed
+	bool done;
+} console_input;
+
 /******************************************************************************/
 /*****************************  Public Declarations ***************************/
 /******************************************************************************/
 int32_t adi_do_console_menu(const console_menu * menu);
+int32_t adi_console_menu_build_key_index(const console_menu *menu);
+int32_t adi_console_menu_start(console_menu_engine *engine,
+			       const console_menu *menu);
+int32_t adi_console_menu_process_key(console_menu_engine *engine,
+				     char keyPressed);
+int32_t adi_console_menu_poll(console_menu_engine *engine);
+int32_t adi_do_console_dashboard(const console_dashboard *dashboard);
+int32_t adi_console_dashboard_start(const console_dashboard *dashboard);
+int32_t adi_console_dashboard_poll(const console_dashboard *dashboard);
+int32_t adi_console_menu_exec_command(const console_menu *menu,
+				      const char *command);
+int32_t adi_do_console_menu_command_mode(const console_menu *menu);
+void adi_console_input_start(console_input *input,
+			     enum console_input_type type,
+			     uint8_t input_len);
+bool adi_console_input_feed(console_input *input, char ch);
+bool adi_console_input_poll(console_input *input);
+int32_t adi_console_input_get_int(const console_input *input);
+float adi_console_input_get_float(const console_input *input);
 int32_t adi_get_decimal_int(uint8_t input_len);
 uint32_t adi_get_hex_integer(uint8_t input_len);
 float adi_get_decimal_float(uint8_t input_len);
@@ -123,6 +282,7 @@ int32_t adi_handle_user_input_float(const char* menu_prompt,
 	uint8_t max_attempts,
 	uint8_t clear_lines);
 void adi_clear_console(void);
+void adi_console_menu_invalidate(void);
 void adi_clear_last_menu_error(void);
 int32_t adi_get_last_menu_error(void);
 void adi_press_any_key_to_continue(void);
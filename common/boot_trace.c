@@ -0,0 +1,181 @@
+/***************************************************************************//**
+ * @file    boot_trace.c
+ * @brief   Boot-time profiling trace
+ * @details Records (tag, timestamp) events into a static array during the
+ *          firmware start-up so that the time spent into each boot step can
+ *          be measured. Host builds (BOOT_TRACE_HOST) use the monotonic system
+ *          clock, target builds use the no-OS platform time.
+********************************************************************************
+* Copyright (c) 2023 Analog Devices, Inc.
+* All rights reserved.
+*
+* This software is proprietary to Analog Devices, Inc. and its licensors.
+* By using this software you agree to the terms of the associated
+* Analog Devices Software License Agreement.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdio.h>
+
+#if defined(BOOT_TRACE_HOST)
+#include <time.h>
+#else
+#include "no_os_delay.h"
+#endif
+
+#include "boot_trace.h"
+#include "no_os_error.h"
+
+/******************************************************************************/
+/******************** Variables and User Defined Data Types *******************/
+/******************************************************************************/
+
+/* Recorded boot trace events */
+static struct boot_trace_event boot_trace_events[BOOT_TRACE_MAX_EVENTS];
+
+/* Number of recorded boot trace events */
+static uint32_t boot_trace_events_cnt;
+
+/* Number of events dropped due to full trace buffer */
+static uint32_t boot_trace_events_dropped;
+
+/******************************************************************************/
+/************************** Functions Definitions *****************************/
+/******************************************************************************/
+
+/**
+ * @brief 	Get the current timestamp
+ * @return	Timestamp in microseconds
+ */
+static uint64_t boot_trace_get_timestamp(void)
+{
+#if defined(BOOT_TRACE_HOST)
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ((uint64_t)ts.tv_sec * 1000000) + (ts.tv_nsec / 1000);
+#else
+	struct no_os_time now = no_os_get_time();
+
+	return ((uint64_t)now.s * 1000000) + now.us;
+#endif
+}
+
+/**
+ * @brief 	Record a boot trace event
+ * @param	tag[in] - Event tag (must have static storage)
+ * @return	None
+ */
+void boot_trace_record(const char *tag)
+{
+	if (boot_trace_events_cnt >= BOOT_TRACE_MAX_EVENTS) {
+		boot_trace_events_dropped++;
+		return;
+	}
+
+	boot_trace_events[boot_trace_events_cnt].tag = tag;
+	boot_trace_events[boot_trace_events_cnt].timestamp_us =
+		boot_trace_get_timestamp();
+	boot_trace_events_cnt++;
+}
+
+/**
+ * @brief 	Clear all the recorded boot trace events
+ * @return	None
+ */
+void boot_trace_reset(void)
+{
+	boot_trace_events_cnt = 0;
+	boot_trace_events_dropped = 0;
+}
+
+/**
+ * @brief 	Get the number of recorded boot trace events
+ * @return	Recorded events count
+ */
+uint32_t boot_trace_get_count(void)
+{
+	return boot_trace_events_cnt;
+}
+
+/**
+ * @brief 	Get the recorded boot trace event
+ * @param	indx[in] - Event index
+ * @return	Pointer to event, NULL if index is out of range
+ */
+const struct boot_trace_event *boot_trace_get_event(uint32_t indx)
+{
+	if (indx >= boot_trace_events_cnt) {
+		return NULL;
+	}
+
+	return &boot_trace_events[indx];
+}
+
+/**
+ * @brief 	Format the boot trace into a compact string
+ * @param	buf[in,out] - Output string buffer
+ * @param	len[in] - Output buffer length
+ * @return	0 in case of success, negative error code otherwise
+ * @note	Events are formatted as "tag=usec" pairs separated by space,
+ *			timestamps being relative to the first recorded event. This
+ *			format is suited for exposing the trace as IIO context attribute.
+ */
+int32_t boot_trace_format(char *buf, uint32_t len)
+{
+	uint32_t cnt;
+	uint32_t pos = 0;
+	int ret;
+
+	if (!buf || !len) {
+		return -EINVAL;
+	}
+
+	buf[0] = '\0';
+
+	for (cnt = 0; cnt < boot_trace_events_cnt; cnt++) {
+		ret = snprintf(&buf[pos], len - pos, "%s%s=%lu",
+			       cnt ? " " : "",
+			       boot_trace_events[cnt].tag,
+			       (unsigned long)(boot_trace_events[cnt].timestamp_us -
+					       boot_trace_events[0].timestamp_us));
+		if (ret < 0 || (uint32_t)ret >= len - pos) {
+			return -ENOBUFS;
+		}
+
+		pos += ret;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief 	Print the boot trace over the console
+ * @return	None
+ */
+void boot_trace_print(void)
+{
+	uint32_t cnt;
+	uint64_t delta;
+
+	printf("Boot trace (%lu events):\r\n", (unsigned long)boot_trace_events_cnt);
+
+	for (cnt = 0; cnt < boot_trace_events_cnt; cnt++) {
+		delta = cnt ? (boot_trace_events[cnt].timestamp_us -
+			       boot_trace_events[cnt - 1].timestamp_us) : 0;
+
+		printf("%10lu us (+%lu us)  %s\r\n",
+		       (unsigned long)(boot_trace_events[cnt].timestamp_us -
+				       boot_trace_events[0].timestamp_us),
+		       (unsigned long)delta,
+		       boot_trace_events[cnt].tag);
+	}
+
+	if (boot_trace_events_dropped) {
+		printf("%lu events dropped\r\n", (unsigned long)boot_trace_events_dropped);
+	}
+}
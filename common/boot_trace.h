@@ -0,0 +1,59 @@
+/***************************************************************************//*
+ * @file    boot_trace.h
+ * @brief   Boot-time profiling trace headers
+******************************************************************************
+ * Copyright (c) 2023 Analog Devices, Inc.
+ * All rights reserved.
+ *
+ * This software is proprietary to Analog Devices, Inc. and its licensors.
+ * By using this software you agree to the terms of the associated
+ * Analog Devices Software License Agreement.
+******************************************************************************/
+
+#ifndef BOOT_TRACE_H_
+#define BOOT_TRACE_H_
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdint.h>
+
+/******************************************************************************/
+/********************** Macros and Constants Definition ***********************/
+/******************************************************************************/
+
+/* Maximum number of boot trace events that can be recorded */
+#if !defined(BOOT_TRACE_MAX_EVENTS)
+#define BOOT_TRACE_MAX_EVENTS	32
+#endif
+
+/* Record a boot trace event. Tracing is compiled in only when
+ * BOOT_TRACE_ENABLE is defined, otherwise events cost nothing.
+ * The tag must be a string literal (or any string with static storage) */
+#if defined(BOOT_TRACE_ENABLE)
+#define BOOT_TRACE(tag)		boot_trace_record(tag)
+#else
+#define BOOT_TRACE(tag)		do {} while (0)
+#endif
+
+/******************************************************************************/
+/********************** Public/Extern Declarations ****************************/
+/******************************************************************************/
+
+/* Boot trace event */
+struct boot_trace_event {
+	/* Event tag */
+	const char *tag;
+	/* Event timestamp in microseconds */
+	uint64_t timestamp_us;
+};
+
+void boot_trace_record(const char *tag);
+void boot_trace_reset(void);
+uint32_t boot_trace_get_count(void);
+const struct boot_trace_event *boot_trace_get_event(uint32_t indx);
+int32_t boot_trace_format(char *buf, uint32_t len);
+void boot_trace_print(void);
+
+#endif /* BOOT_TRACE_H_ */
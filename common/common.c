@@ -16,6 +16,7 @@
 
 #include "common.h"
 #include "board_info.h"
+#include "boot_trace.h"
 #if defined (TARGET_SDP_K1)
 #include "sdp_k1_sdram.h"
 #endif
@@ -28,6 +29,9 @@
  * at 180Mhz core clock frequency */
 #define EEPROM_OPS_START_DELAY		0xfffff
 
+/* Maximum length of the boot trace context attribute string */
+#define BOOT_TRACE_ATTR_MAX_LEN		512
+
 /******************************************************************************/
 /******************** Variables and User Defined Data Types *******************/
 /******************************************************************************/
@@ -47,6 +51,11 @@ static struct board_info board_info;
 static uint8_t eeprom_detected_dev_addr;
 static bool valid_eeprom_addr_detected;
 
+#if defined(BOOT_TRACE_ENABLE)
+/* Boot trace exposed as IIO context attribute */
+static char boot_trace_attr[BOOT_TRACE_ATTR_MAX_LEN];
+#endif
+
 /******************************************************************************/
 /************************** Functions Definitions *****************************/
 /******************************************************************************/
@@ -68,6 +77,8 @@ int32_t eeprom_init(struct no_os_eeprom_desc **eeprom_desc,
 		return -EINVAL;
 	}
 
+	BOOT_TRACE("eeprom_init");
+
 #if defined (TARGET_SDP_K1)
 	/* ~100msec Delay before starting EEPROM operations for SDP-K1.
 	 * This delay makes sure that MCU is stable after power on
@@ -76,6 +87,7 @@ int32_t eeprom_init(struct no_os_eeprom_desc **eeprom_desc,
 #endif
 
 	ret = no_os_eeprom_init(eeprom_desc, eeprom_init_params);
+	BOOT_TRACE("eeprom_init_done");
 	if (ret) {
 		return ret;
 	}
@@ -127,6 +139,8 @@ static int32_t validate_eeprom(struct no_os_eeprom_desc *eeprom_desc)
 		return -EINVAL;
 	}
 
+	BOOT_TRACE("validate_eeprom");
+
 	/* Detect valid EEPROM */
 	valid_eeprom_addr_detected = false;
 	for (eeprom_addr = EEPROM_DEV_ADDR_START;
@@ -145,6 +159,8 @@ static int32_t validate_eeprom(struct no_os_eeprom_desc *eeprom_desc)
 		}
 	}
 
+	BOOT_TRACE("validate_eeprom_done");
+
 	if (!valid_eeprom_addr_detected) {
 		printf("No valid EEPROM address detected\r\n");
 	} else {
@@ -199,6 +215,8 @@ int32_t get_iio_context_attributes(struct iio_ctx_attr **ctx_attr,
 		return -EINVAL;
 	}
 
+	BOOT_TRACE("get_iio_context_attributes");
+
 	ret = validate_eeprom(eeprom_desc);
 	if (ret) {
 		return ret;
@@ -206,7 +224,9 @@ int32_t get_iio_context_attributes(struct iio_ctx_attr **ctx_attr,
 
 	if (is_eeprom_valid_dev_addr_detected()) {
 		/* Read the board information from EEPROM */
+		BOOT_TRACE("read_board_info");
 		ret = read_board_info(eeprom_desc, &board_info);
+		BOOT_TRACE("read_board_info_done");
 		if (ret) {
 			board_detect_error = true;
 		} else {
@@ -240,6 +260,10 @@ int32_t get_iio_context_attributes(struct iio_ctx_attr **ctx_attr,
 	num_of_context_attributes++;
 #endif
 
+#if defined(BOOT_TRACE_ENABLE)
+	num_of_context_attributes++;
+#endif
+
 	/* Allocate dynamic memory for context attributes based on number of attributes
 	 * detected/available */
 	context_attributes = (struct iio_ctx_attr *)calloc(
@@ -277,6 +301,16 @@ int32_t get_iio_context_attributes(struct iio_ctx_attr **ctx_attr,
 		cnt++;
 	}
 
+#if defined(BOOT_TRACE_ENABLE)
+	/* Boot trace holds the events recorded until this point of time */
+	BOOT_TRACE("get_iio_context_attributes_done");
+	if (!boot_trace_format(boot_trace_attr, sizeof(boot_trace_attr))) {
+		(context_attributes + cnt)->name = "boot_trace";
+		(context_attributes + cnt)->value = boot_trace_attr;
+		cnt++;
+	}
+#endif
+
 	num_of_context_attributes = cnt;
 	*ctx_attr = context_attributes;
 	*attrs_cnt = num_of_context_attributes;
@@ -291,9 +325,11 @@ int32_t get_iio_context_attributes(struct iio_ctx_attr **ctx_attr,
 int32_t sdram_init(void)
 {
 #if defined (TARGET_SDP_K1)
+	BOOT_TRACE("sdram_init");
 	if (SDP_SDRAM_Init() != SDRAM_OK) {
 		return -EIO;
 	}
+	BOOT_TRACE("sdram_init_done");
 #endif
 
 	return 0;
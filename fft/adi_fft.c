@@ -15,23 +15,12 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 #include <errno.h>
 #include "adi_fft.h"
 #include "adi_fft_windowing.h"
-
-/******************************************************************************/
-/************************ Macros/Constants ************************************/
-/******************************************************************************/
-
-/* Ignoring certain amount of DC bins for noise and other calculations */
-#define ADI_FFT_DC_BINS		10
-
-/* Power spread of the fundamental, 10 bins from either side of the fundamental */
-#define ADI_FFT_FUND_BINS	10
-
-/* Power spread of the harmonic, 3 bins from either side of the harmonic */
-#define ADI_FFT_HARM_BINS	3
+#include "adi_fft_mixed_radix.h"
 
 /******************************************************************************/
 /******************** Variables and User Defined Data Types *******************/
@@ -40,10 +29,61 @@
 /* Instance for the floating-point CFFT/CIFFT */
 static arm_cfft_instance_f32 cfft_instance;
 
+/* Plan for the FFT lengths which are not a power of 2, kept until the FFT
+ * length changes */
+static struct adi_fft_mixed_radix *mixed_radix_plan;
+
+/* Min-heap of the highest spurs found by the noise analysis, the smallest of
+ * them being at the root */
+struct adi_fft_spur_heap {
+	/* Corrected magnitude of the spurs */
+	float mag[ADI_FFT_MAX_SPURS];
+	/* Bin of the spurs */
+	uint16_t bin[ADI_FFT_MAX_SPURS];
+	/* Number of spurs in the heap */
+	uint8_t count;
+	/* Max number of spurs kept */
+	uint8_t size;
+};
+
 /******************************************************************************/
 /************************ Functions Definitions *******************************/
 /******************************************************************************/
 
+/**
+ * @brief Prepare the FFT computation for a given length
+ * @param length[in] - FFT length
+ * @return 0 in case of success, negative error code otherwise
+ * @note Power of 2 lengths are computed with the CMSIS-DSP CFFT, any other
+ *	 length with a mixed radix (or Bluestein) plan.
+ */
+static int adi_fft_plan(uint16_t length)
+{
+	if (!length)
+		return -EINVAL;
+
+	if (!(length & (length - 1))) {
+		/* Release the plan of the previous length */
+		if (mixed_radix_plan) {
+			adi_fft_mixed_radix_remove(mixed_radix_plan);
+			mixed_radix_plan = NULL;
+		}
+
+		return arm_cfft_init_f32(&cfft_instance, length);
+	}
+
+	/* Plan already computed for this length */
+	if (mixed_radix_plan && mixed_radix_plan->length == length)
+		return 0;
+
+	if (mixed_radix_plan) {
+		adi_fft_mixed_radix_remove(mixed_radix_plan);
+		mixed_radix_plan = NULL;
+	}
+
+	return adi_fft_mixed_radix_init(&mixed_radix_plan, length);
+}
+
 /**
  * @brief Initialize the FFT structure
  * @param param[in] - FFT init parameters
@@ -69,14 +109,26 @@ int adi_fft_init(struct adi_fft_init_params *param,
 	fft_proc->cnv_data_to_volt_wrt_vref = param->convert_data_to_volt_wrt_vref;
 	fft_proc->cnv_code_to_straight_binary =
 		param->convert_code_to_straight_binary;
+	fft_proc->input_filter = param->input_filter;
+	fft_proc->input_filter_ctx = param->input_filter_ctx;
 	fft_proc->fft_length = param->samples_count;
 	fft_proc->window = BLACKMAN_HARRIS_7TERM;
+	fft_proc->dc_bins = ADI_FFT_DC_BINS;
+	fft_proc->fund_bins = ADI_FFT_FUND_BINS;
+	fft_proc->harm_bins = ADI_FFT_HARM_BINS;
+	fft_proc->outputs = ADI_FFT_OUT_ALL;
+	fft_proc->max_spurs = ADI_FFT_MAX_SPURS;
 	fft_proc->bin_width = 0.0;
+#if defined(ADI_FFT_MINIMAL_MEMORY)
+	fft_proc->fft_magnitude = fft_proc->fft_input;
+	fft_proc->fft_magnitude_corrected = fft_proc->fft_input;
+#endif
 	fft_proc->fft_done = false;
 
 	fft_meas->fundamental = 0.0;
 	fft_meas->pk_spurious_noise = 0.0;
 	fft_meas->pk_spurious_freq = 0;
+	fft_meas->spurs_count = 0;
 	fft_meas->THD = 0.0;
 	fft_meas->SNR = 0.0;
 	fft_meas->DR = 0.0;
@@ -103,7 +155,7 @@ int adi_fft_init(struct adi_fft_init_params *param,
 		fft_meas->harmonics_power[cnt] = 0.0;
 	}
 
-	return arm_cfft_init_f32(&cfft_instance, fft_proc->fft_length);
+	return adi_fft_plan(fft_proc->fft_length);
 }
 
 /**
@@ -121,8 +173,10 @@ int adi_fft_update_params(struct adi_fft_init_params *param,
 	fft_proc->fft_length = param->samples_count;
 	fft_proc->sample_rate = param->sample_rate;
 	fft_proc->vref = param->vref;
+	fft_proc->input_filter = param->input_filter;
+	fft_proc->input_filter_ctx = param->input_filter_ctx;
 
-	return arm_cfft_init_f32(&cfft_instance, fft_proc->fft_length);
+	return adi_fft_plan(fft_proc->fft_length);
 }
 
 /**
@@ -137,107 +191,222 @@ float static adi_fft_dbfs_to_volts(float vref, float value)
 }
 
 /**
- * @brief Windowing function for FFT
- * @param fft_proc[in,out] - FFT processing parameters
+ * @brief Load the FFT input: DC offset removal, conversion to volts and windowing
+ * @param fft_proc[in] - FFT processing parameters
+ * @param data[in] - Input data (straight binary for ADCs)
+ * @param fraction[in] - Fractional part of the input data codes (optional)
+ * @param fft_input[out] - FFT input, complex interleaved
+ * @param offset[in] - DC offset of the input data
  * @param sum[in,out] - pointer to sum of all the coeffs
  * @return 0 in case of success, negative error code otherwise
+ * @note All the steps are done in a single pass over the data. Samples are
+ *	 loaded from the last one, so that the input data can share its memory
+ *	 with the FFT input (ADI_FFT_MINIMAL_MEMORY).
  */
-static int adi_fft_windowing(struct adi_fft_processing *fft_proc,
-			     double *sum)
+static int adi_fft_load_input(struct adi_fft_processing *fft_proc,
+			      const int32_t *data, const float *fraction,
+			      float *fft_input, int32_t offset, double *sum)
 {
 	uint8_t iter;
 	uint16_t cnt;
-	double term = 0.0;
+	int32_t sample;
+	double term;
+	float lsb = 0.0;
 	const double sample_count = (fft_proc->fft_length * 2) - 1;
 
 	if (!sum || !fft_proc)
 		return -EINVAL;
 
-	for (cnt = 0; cnt < fft_proc->fft_length * 2; cnt+=2) {
-		switch (fft_proc->window) {
-		case BLACKMAN_HARRIS_7TERM:
-			if (fft_proc->fft_length <= 2048)
-				/* Use precalculated coeficients for first 2048 samples */
-				term = adi_fft_7_term_bh_4096[cnt / 2];
-			else {
-				for (iter = 0; iter < ADI_FFT_NUM_OF_TERMS; iter++)
-					term += adi_fft_7_term_bh_coefs[iter] * cos((double)((2.0 * PI * iter *
-							(cnt / 2))) / sample_count);
-			}
-			break;
+	/* Volts of a code, for the fractional part of the codes */
+	if (fraction)
+		lsb = fft_proc->cnv_data_to_volt_without_vref(1, 0) -
+		      fft_proc->cnv_data_to_volt_without_vref(0, 0);
 
-		case RECTANGULAR:
+	if (fft_proc->window != BLACKMAN_HARRIS_7TERM
+	    && fft_proc->window != RECTANGULAR)
+		return -EINVAL;
+
+	for (cnt = fft_proc->fft_length; cnt-- > 0;) {
+		/* Codes without DC offset */
+		sample = data[cnt] - offset;
+
+		if (fft_proc->window == RECTANGULAR)
 			/* No window, all terms = 1 */
 			term = 1;
-			break;
-
-		default:
-			return -EINVAL;
+		else if (fft_proc->fft_length <= 2048)
+			/* Use precalculated coeficients for first 2048 samples */
+			term = adi_fft_7_term_bh_4096[cnt];
+		else {
+			term = 0.0;
+			for (iter = 0; iter < ADI_FFT_NUM_OF_TERMS; iter++)
+				term += adi_fft_7_term_bh_coefs[iter] * cos((double)((2.0 * PI * iter *
+						cnt)) / sample_count);
 		}
 
 		/*  Get sum of all terms, which will be used for amplitude correction */
 		*sum += term;
 
-		/* Multiplying each (real) sample by windowing term */
-		fft_proc->fft_input[cnt] *= (float)(term);
-		term = 0.0;
+		/* Imaginary part (always zero for complex FFT) */
+		fft_input[cnt * 2 + 1] = 0;
+
+		/* Real part, converted to "volts" without respect to Vref voltage
+		 * and multiplied by the windowing term */
+		fft_input[cnt * 2] = fft_proc->cnv_data_to_volt_without_vref(sample,
+				     0) * (float)term;
+		if (fraction)
+			fft_input[cnt * 2] += fraction[cnt] * lsb * (float)term;
 	}
 
 	return 0;
 }
 
 /**
- * @brief Transfer magnitude to dB
- * @param fft_proc[in,out] - FFT processing parameters
- * @param sum[in] - sum of all windowing coeffs
+ * @brief Get the sum of the windowing coeffs used for amplitude correction
+ * @param fft_proc[in] - FFT processing parameters
+ * @param sum[in] - sum of all windowing coeffs, as loaded in the FFT input
+ * @param coeff_sum[out] - sum of coeffs used for the correction
  * @return 0 in case of success, negative error code otherwise
  */
-static int adi_fft_magnitude_to_db(struct adi_fft_processing *fft_proc,
-				   double sum)
+static int adi_fft_window_sum(struct adi_fft_processing *fft_proc, double sum,
+			      float *coeff_sum)
 {
-	uint16_t cnt;
-	float correction;
-	float coeff_sum;
-
-	if (!fft_proc)
-		return -EINVAL;
-
 	/* Getting sum of coeffs.
 	 * If rectangular window is choosen = no windowing, sum of coeffs
 	 * is number of samples
 	 **/
 	if ((fft_proc->fft_length == 2048)
 	    && (fft_proc->window == BLACKMAN_HARRIS_7TERM))
-		coeff_sum = adi_fft_7_term_bh_4096_sum;
+		*coeff_sum = adi_fft_7_term_bh_4096_sum;
 	else {
 		if (fft_proc->window == RECTANGULAR)
-			coeff_sum = (float)fft_proc->fft_length;
+			*coeff_sum = (float)fft_proc->fft_length;
 		else {
 			if (sum <= 0)
 				return -EINVAL;
 
-			coeff_sum = sum;
+			*coeff_sum = sum;
 		}
 	}
 
+	return 0;
+}
+
+/**
+ * @brief Compute the complex FFT in place with the plan of the FFT length
+ * @param fft_proc[in] - FFT processing parameters
+ * @param fft_input[in,out] - FFT input and output, complex interleaved
+ * @return 0 in case of success, negative error code otherwise
+ */
+static int adi_fft_run(struct adi_fft_processing *fft_proc, float *fft_input)
+{
+	if (fft_proc->fft_length & (fft_proc->fft_length - 1)) {
+		/* Lengths not supported by CMSIS-DSP, plan computed at init */
+		if (!mixed_radix_plan || mixed_radix_plan->length != fft_proc->fft_length)
+			return -EINVAL;
+
+		return adi_fft_mixed_radix_run(mixed_radix_plan, fft_input);
+	}
+
+	/* Perform the FFT through CMSIS-DSP support libraries */
+	arm_cfft_f32(&cfft_instance, fft_input, 0, 1);
+
+	return 0;
+}
+
+/**
+ * @brief Store the spectrum: magnitude, windowing correction and dB
+ * @param fft_proc[in,out] - FFT processing parameters
+ * @param sum[in] - sum of all windowing coeffs
+ * @param db[in] - Convert the corrected magnitude to dB (computed on demand
+ *		   with ADI_FFT_MINIMAL_MEMORY)
+ * @return 0 in case of success, negative error code otherwise
+ * @note All the steps are done in a single pass over the FFT output, first
+ *	 Nyquist zone only. Outputs never overtake the input, so they can
+ *	 overwrite the FFT output (ADI_FFT_MINIMAL_MEMORY).
+ */
+static int adi_fft_store_spectrum(struct adi_fft_processing *fft_proc,
+				  double sum, bool db)
+{
+	uint16_t cnt;
+	float real, imag;
+	float magnitude;
+	float correction;
+	float coeff_sum;
+	int ret;
+
+	if (!fft_proc)
+		return -EINVAL;
+
+#if defined(ADI_FFT_MINIMAL_MEMORY)
+	/* Spectrum in dB is computed on demand */
+	(void)db;
+#endif
+
+	ret = adi_fft_window_sum(fft_proc, sum, &coeff_sum);
+	if (ret)
+		return ret;
+
 	for (cnt = 0; cnt < fft_proc->fft_length / 2; cnt++) {
+		/* Transform from complex FFT to magnitude */
+		real = fft_proc->fft_input[cnt * 2];
+		imag = fft_proc->fft_input[cnt * 2 + 1];
+		magnitude = sqrtf(real * real + imag * imag);
+		fft_proc->fft_magnitude[cnt] = magnitude;
+
 		/* Apply a correction factor
 		 * Divide magnigude by a sum of the windowing function coefficients
 		 * Multiple by 2 because of power spread over spectrum below and above
 		 * the Nyquist frequency
 		 **/
-		correction = (fft_proc->fft_magnitude[cnt] * 2.0) / coeff_sum;
+		correction = (magnitude * 2.0) / coeff_sum;
 
 		/* FFT magnitude with windowing correction */
 		fft_proc->fft_magnitude_corrected[cnt] = correction;
 
+#if !defined(ADI_FFT_MINIMAL_MEMORY)
 		/* Convert to dB without respect to Vref */
-		fft_proc->fft_dB[cnt] = 20.0 * (log10f(correction));
+		if (db)
+			fft_proc->fft_dB[cnt] = 20.0 * (log10f(correction));
+#endif
 	}
 
 	return 0;
 }
 
+/**
+ * @brief Get the bins range of the power spread around a spectrum peak
+ * @param fft_proc[in] - FFT processing parameters
+ * @param center[in] - Bin of the peak
+ * @param spread[in] - Bins from either side of the peak
+ * @param first[out] - First bin of the range
+ * @param last[out] - Last bin of the range
+ * @return none
+ */
+static void adi_fft_spread_bins(struct adi_fft_processing *fft_proc,
+				uint16_t center, uint16_t spread,
+				uint16_t *first, uint16_t *last)
+{
+	*first = (center > spread) ? center - spread : 0;
+	*last = ((uint32_t)center + spread < fft_proc->fft_length / 2) ?
+		center + spread : fft_proc->fft_length / 2 - 1;
+}
+
+/**
+ * @brief Get the FFT effective gain of a bin
+ * @param fft_proc[in] - FFT processing parameters
+ * @param bin[in] - Bin of the first Nyquist zone
+ * @return Bin magnitude in dB (-200 dB if the bin is out of range)
+ * @note The value is computed from the corrected magnitude, as the spectrum
+ *	 in dB is not stored with ADI_FFT_MINIMAL_MEMORY.
+ */
+float adi_fft_get_bin_db(struct adi_fft_processing *fft_proc, uint16_t bin)
+{
+	if (!fft_proc || bin >= fft_proc->fft_length / 2)
+		return -200.0;
+
+	return 20.0 * log10f(fft_proc->fft_magnitude_corrected[bin]);
+}
+
 /**
  * @brief THD calculation with support of harmonics folding
  *        to 1-st nyquist zone
@@ -248,23 +417,25 @@ static int adi_fft_magnitude_to_db(struct adi_fft_processing *fft_proc,
 static int adi_fft_calculate_thd(struct adi_fft_processing *fft_proc,
 				 struct adi_fft_measurements *fft_meas)
 {
-	const uint16_t first_nyquist_zone = fft_proc->fft_length;
-	uint16_t i, j, k = 0, fund_freq = 0, harmonic_position;
-	int8_t m, nyquist_zone;
-	float mag_helper = -200.0, freq_helper, sum = 0.0, fund_mag = -200.0;
-	float fund_pow_bins[21], harm_pow_bins[5][ADI_FFT_NUM_OF_TERMS];
+	const uint16_t first_nyquist_zone = fft_proc->fft_length / 2;
+	uint16_t i, j, fund_freq = 0, harmonic_position, first, last;
+	int8_t nyquist_zone;
+	int32_t m;
+	float mag_helper, freq_helper, sum = 0.0, fund_mag = 0.0;
 
 	if (!fft_proc || !fft_meas)
 		return -EINVAL;
 
-	/* Looking for the fundamental frequency and amplitude */
-	for (i = ADI_FFT_DC_BINS; i < fft_proc->fft_length / 2; i++) {
+	/* Looking for the fundamental frequency and amplitude. Peaks are
+	 * searched on the magnitude, only the peaks being converted to dB */
+	for (i = fft_proc->dc_bins; i < fft_proc->fft_length / 2; i++) {
 		/* Not counting DC bins */
-		if (fft_proc->fft_dB[i] > fund_mag) {
-			fund_mag = fft_proc->fft_dB[i];
+		if (fft_proc->fft_magnitude_corrected[i] > fund_mag) {
+			fund_mag = fft_proc->fft_magnitude_corrected[i];
 			fund_freq = i;
 		}
 	}
+	fund_mag = adi_fft_get_bin_db(fft_proc, fund_freq);
 
 	/* Get first harmonic measurements */
 	fft_meas->harmonics_freq[0] = fund_freq;
@@ -292,44 +463,47 @@ static int adi_fft_calculate_thd(struct adi_fft_processing *fft_proc,
 						    fft_meas->harmonics_freq[0] * (i + 1);
 		}
 
-		/* Extend searching range by 3 bins around expected position of the harmonic */
-		for (m = -ADI_FFT_HARM_BINS ; m <= ADI_FFT_HARM_BINS ; m++) {
-			if (fft_proc->fft_dB[harmonic_position + m] > mag_helper) {
-				mag_helper = fft_proc->fft_dB[harmonic_position + m];
+		/* Default to the expected position, the first bin in range
+		 * always replacing it, even on an all-zero spectrum */
+		freq_helper = harmonic_position < first_nyquist_zone ?
+			      harmonic_position : first_nyquist_zone - 1;
+		mag_helper = -1.0;
+
+		/* Extend searching range by the harmonic spread around its expected position */
+		for (m = -(int32_t)fft_proc->harm_bins; m <= fft_proc->harm_bins; m++) {
+			if (harmonic_position + m < 0
+			    || harmonic_position + m >= fft_proc->fft_length / 2)
+				continue;
+
+			if (fft_proc->fft_magnitude_corrected[harmonic_position + m] > mag_helper) {
+				mag_helper = fft_proc->fft_magnitude_corrected[harmonic_position + m];
 				freq_helper = (harmonic_position + m);
 			}
 		}
 
 		fft_meas->harmonics_freq[i] = freq_helper;
-		fft_meas->harmonics_mag_dbfs[i]  = mag_helper;
-		mag_helper = -200.0;
+		fft_meas->harmonics_mag_dbfs[i]  = adi_fft_get_bin_db(fft_proc, freq_helper);
 	}
 
 	/* Power leakage of the fundamental */
-	for (i = fft_meas->harmonics_freq[0] - ADI_FFT_FUND_BINS;
-	     i <= fft_meas->harmonics_freq[0] + ADI_FFT_FUND_BINS; i++) {
+	adi_fft_spread_bins(fft_proc, fft_meas->harmonics_freq[0],
+			    fft_proc->fund_bins, &first, &last);
+	for (i = first; i <= last; i++)
 		sum += powf(((fft_proc->fft_magnitude_corrected[i] / (2.0*sqrt(2)))), 2.0);
-		fund_pow_bins[k] = fft_proc->fft_magnitude_corrected[i];
-		k++;
-	}
 
 	/* Finishing the RSS of power-leaked fundamental */
 	sum = sqrt(sum);
 	fft_meas->harmonics_power[0] = sum * 2.0 * sqrt(2);
 	sum = 0.0;
-	k = 0;
 
 	/* Power leakage of the harmonics */
 	for (j = 1; j < ADI_FFT_NUM_OF_TERMS - 1; j++) {
-		for (i = fft_meas->harmonics_freq[j] - ADI_FFT_HARM_BINS;
-		     i <= fft_meas->harmonics_freq[j] + ADI_FFT_HARM_BINS; i++) {
+		adi_fft_spread_bins(fft_proc, fft_meas->harmonics_freq[j],
+				    fft_proc->harm_bins, &first, &last);
+		for (i = first; i <= last; i++)
 			sum += powf(((fft_proc->fft_magnitude_corrected[i] / (2.0*sqrt(2)))), 2.0);
-			harm_pow_bins[j - 1][k] = fft_proc->fft_magnitude_corrected[i];
-			k++;
-		}
 
 		/* Finishing the RSS of power-leaked harmonics */
-		k = 0;
 		sum = sqrt(sum);
 		fft_meas->harmonics_power[j] = sum * 2.0 * sqrt(2);
 		sum = 0.0;
@@ -352,10 +526,12 @@ static int adi_fft_calculate_thd(struct adi_fft_processing *fft_proc,
  * @brief Calculate amplitudes: min, max, pk-pk amplitude and DC part
  * @param fft_proc[in,out] - FFT processing parameters
  * @param fft_meas[in,out] - FFT measurement parameters
+ * @param offset[out] - DC offset of the input data
  * @return 0 in case of success, negative error code otherwise
  */
 static int adi_fft_waveform_stat(struct adi_fft_processing *fft_proc,
-				 struct adi_fft_measurements *fft_meas)
+				 struct adi_fft_measurements *fft_meas,
+				 int32_t *offset)
 {
 	uint16_t cnt;
 	int16_t max_position, min_position;
@@ -425,13 +601,162 @@ static int adi_fft_waveform_stat(struct adi_fft_processing *fft_proc,
 	/* RMS noise */
 	fft_meas->RMS_noise = fft_meas->transition_noise;
 
-	/* Applying mean value to each sample = removing DC offset */
-	for (cnt = 0; cnt < fft_proc->fft_length; cnt++)
-		fft_proc->input_data[cnt] -= offset_correction;
+	/* Mean value removed from each sample when loading the FFT input */
+	*offset = offset_correction;
 
 	return 0;
 }
 
+/**
+ * @brief Check if a bin is part of the power spread of the fundamental or
+ *        of a harmonic
+ * @param fft_proc[in] - FFT processing parameters
+ * @param fft_meas[in] - FFT measurement parameters
+ * @param bin[in] - Bin to check
+ * @return true if the bin is excluded from the noise
+ */
+static bool adi_fft_is_harmonic_bin(struct adi_fft_processing *fft_proc,
+				    struct adi_fft_measurements *fft_meas,
+				    uint16_t bin)
+{
+	uint16_t first, last;
+	uint8_t cnt;
+
+	for (cnt = 0; cnt < ADI_FFT_NUM_OF_TERMS - 1; cnt++) {
+		adi_fft_spread_bins(fft_proc, fft_meas->harmonics_freq[cnt],
+				    cnt ? fft_proc->harm_bins : fft_proc->fund_bins,
+				    &first, &last);
+		if (bin >= first && bin <= last)
+			return true;
+	}
+
+	return false;
+}
+
+/**
+ * @brief Swap two spurs of the heap
+ * @param heap[in,out] - Spurs heap
+ * @param i[in] - First spur index
+ * @param j[in] - Second spur index
+ * @return none
+ */
+static void adi_fft_spur_heap_swap(struct adi_fft_spur_heap *heap, uint8_t i,
+				   uint8_t j)
+{
+	float mag = heap->mag[i];
+	uint16_t bin = heap->bin[i];
+
+	heap->mag[i] = heap->mag[j];
+	heap->bin[i] = heap->bin[j];
+	heap->mag[j] = mag;
+	heap->bin[j] = bin;
+}
+
+/**
+ * @brief Restore the heap order from a given spur down to the leaves
+ * @param heap[in,out] - Spurs heap
+ * @param i[in] - Spur index
+ * @return none
+ */
+static void adi_fft_spur_heap_sift_down(struct adi_fft_spur_heap *heap,
+					uint8_t i)
+{
+	uint8_t child, smallest;
+
+	while (true) {
+		smallest = i;
+		for (child = 2 * i + 1; child <= 2 * i + 2 && child < heap->count; child++) {
+			if (heap->mag[child] < heap->mag[smallest])
+				smallest = child;
+		}
+		if (smallest == i)
+			return;
+
+		adi_fft_spur_heap_swap(heap, i, smallest);
+		i = smallest;
+	}
+}
+
+/**
+ * @brief Keep a spur if it is among the highest ones found so far
+ * @param heap[in,out] - Spurs heap
+ * @param mag[in] - Corrected magnitude of the spur
+ * @param bin[in] - Bin of the spur
+ * @return none
+ */
+static void adi_fft_spur_heap_push(struct adi_fft_spur_heap *heap, float mag,
+				   uint16_t bin)
+{
+	uint8_t i;
+
+	if (heap->count < heap->size) {
+		/* Heap not full, sift the new spur up */
+		i = heap->count++;
+		heap->mag[i] = mag;
+		heap->bin[i] = bin;
+		while (i && heap->mag[(i - 1) / 2] > heap->mag[i]) {
+			adi_fft_spur_heap_swap(heap, i, (i - 1) / 2);
+			i = (i - 1) / 2;
+		}
+	} else if (heap->size && mag > heap->mag[0]) {
+		/* Replace the smallest spur */
+		heap->mag[0] = mag;
+		heap->bin[0] = bin;
+		adi_fft_spur_heap_sift_down(heap, 0);
+	}
+}
+
+/**
+ * @brief Check if a bin is the peak of a spur
+ * @param fft_proc[in] - FFT processing parameters
+ * @param bin[in] - FFT bin
+ * @return true if the bin is a local maximum of the spectrum
+ * @note The bins leaked by a spur around its peak are not local maximums, so
+ *	 they are merged into a single spur.
+ */
+static bool adi_fft_is_spur_peak(struct adi_fft_processing *fft_proc,
+				 uint16_t bin)
+{
+	const float *mag = fft_proc->fft_magnitude_corrected;
+
+	if (bin && mag[bin] < mag[bin - 1])
+		return false;
+
+	if (bin + 1 < fft_proc->fft_length / 2 && mag[bin] <= mag[bin + 1])
+		return false;
+
+	return true;
+}
+
+/**
+ * @brief Report the spurs of the heap, highest first
+ * @param fft_proc[in] - FFT processing parameters
+ * @param fft_meas[in,out] - FFT measurements parameters
+ * @param heap[in,out] - Spurs heap, emptied
+ * @return none
+ */
+static void adi_fft_report_spurs(struct adi_fft_processing *fft_proc,
+				 struct adi_fft_measurements *fft_meas,
+				 struct adi_fft_spur_heap *heap)
+{
+	struct adi_fft_spur *spur;
+
+	fft_meas->spurs_count = heap->count;
+
+	/* Pop the smallest spur to the end of the list */
+	while (heap->count) {
+		spur = &fft_meas->spurs[heap->count - 1];
+		spur->bin = heap->bin[0];
+		spur->freq = heap->bin[0] * fft_proc->bin_width;
+		spur->dbfs = adi_fft_get_bin_db(fft_proc, heap->bin[0]);
+		spur->dbc = spur->dbfs - fft_meas->harmonics_mag_dbfs[0];
+
+		heap->count--;
+		adi_fft_spur_heap_swap(heap, 0, heap->count);
+		adi_fft_spur_heap_sift_down(heap, 0);
+	}
+}
+
 /**
  * @brief Calculate noise from the FFT plot
  * @param fft_proc[in,out] - FFT processing parameters
@@ -447,42 +772,30 @@ static int adi_fft_calculate_noise(struct adi_fft_processing *fft_proc,
 	uint16_t cnt;
 	float biggest_spur = -300;
 	double RSS = 0.0, mean = 0.0;
+	bool noise;
+	struct adi_fft_spur_heap spurs;
 
 	if (!fft_proc || !fft_meas)
 		return -EINVAL;
 
+	spurs.count = 0;
+	spurs.size = (fft_proc->max_spurs < ADI_FFT_MAX_SPURS) ? fft_proc->max_spurs :
+		     ADI_FFT_MAX_SPURS;
+
 	/* Initalizing pk_spurious variables */
 	fft_meas->pk_spurious_noise = -200.0;
 	fft_meas->pk_spurious_freq = 0;
 
-	for (cnt = 0; cnt < ADI_FFT_DC_BINS; cnt++)
-		/* Ignoring DC bins */
-		fft_proc->noise_bins[cnt] = 0.0;
-
-	for (cnt = ADI_FFT_DC_BINS; cnt < fft_proc->fft_length / 2; cnt++) {
-		/* Ignoring spread near the fundamental */
-		if ((cnt <= fft_meas->harmonics_freq[0] + ADI_FFT_FUND_BINS)
-		    && (cnt >= fft_meas->harmonics_freq[0] - ADI_FFT_FUND_BINS))
-			fft_proc->noise_bins[cnt] = 0.0;
-		/* Ignoring spread near harmonics */
-		else if ((cnt <= fft_meas->harmonics_freq[1] + ADI_FFT_HARM_BINS)
-			 && (cnt >= fft_meas->harmonics_freq[1] - ADI_FFT_HARM_BINS))
-			fft_proc->noise_bins[cnt] = 0.0;
-		else if ((cnt <= fft_meas->harmonics_freq[2] + ADI_FFT_HARM_BINS)
-			 && (cnt >= fft_meas->harmonics_freq[2] - ADI_FFT_HARM_BINS))
-			fft_proc->noise_bins[cnt] = 0.0;
-		else if ((cnt <= fft_meas->harmonics_freq[3] + ADI_FFT_HARM_BINS)
-			 && (cnt >= fft_meas->harmonics_freq[3] - ADI_FFT_HARM_BINS))
-			fft_proc->noise_bins[cnt] = 0.0;
-		else if ((cnt <= fft_meas->harmonics_freq[4] + ADI_FFT_HARM_BINS)
-			 && (cnt >= fft_meas->harmonics_freq[4] - ADI_FFT_HARM_BINS))
-			fft_proc->noise_bins[cnt] = 0.0;
-		else if ((cnt <= fft_meas->harmonics_freq[5] + ADI_FFT_HARM_BINS)
-			 && (cnt >= fft_meas->harmonics_freq[5] - ADI_FFT_HARM_BINS))
-			fft_proc->noise_bins[cnt] = 0.0;
-		else {
+	for (cnt = 0; cnt < fft_proc->fft_length / 2; cnt++) {
+		/* Ignoring DC bins and spread near the fundamental and harmonics */
+		noise = (cnt >= fft_proc->dc_bins
+			 && !adi_fft_is_harmonic_bin(fft_proc, fft_meas, cnt));
+#if !defined(ADI_FFT_MINIMAL_MEMORY)
+		fft_proc->noise_bins[cnt] = noise ? fft_proc->fft_magnitude_corrected[cnt] :
+					    0.0;
+#endif
+		if (noise) {
 			/* Root Sum Square = RSS for noise calculations */
-			fft_proc->noise_bins[cnt] = fft_proc->fft_magnitude_corrected[cnt];
 			RSS += pow(((double)(fft_proc->fft_magnitude_corrected[cnt] / (2.0*sqrt(2)))),
 				   2.0);
 
@@ -494,9 +807,16 @@ static int adi_fft_calculate_noise(struct adi_fft_processing *fft_proc,
 				fft_meas->pk_spurious_noise = fft_proc->fft_magnitude_corrected[cnt];
 				fft_meas->pk_spurious_freq = cnt;
 			}
+
+			/* Highest spurs */
+			if (adi_fft_is_spur_peak(fft_proc, cnt))
+				adi_fft_spur_heap_push(&spurs, fft_proc->fft_magnitude_corrected[cnt],
+						       cnt);
 		}
 	}
 
+	adi_fft_report_spurs(fft_proc, fft_meas, &spurs);
+
 	mean /= ((double)fft_proc->fft_length / 2);
 
 	/* RSS of FFT spectrum without DC, Fundamental and Harmonics */
@@ -550,69 +870,297 @@ static int adi_fft_calculate_noise(struct adi_fft_processing *fft_proc,
 }
 
 /**
- * @brief Perform the FFT
- * @param fft_proc[in,out] - FFT processing parameters
+ * @brief Add the dependencies of the selected FFT outputs
+ * @param outputs[in] - Bitmask of the selected outputs
+ * @return Bitmask of the outputs to be computed
+ */
+static uint8_t adi_fft_resolve_outputs(uint8_t outputs)
+{
+	if (outputs & ADI_FFT_OUT_NOISE)
+		outputs |= ADI_FFT_OUT_THD;
+	if (outputs & ADI_FFT_OUT_THD)
+		outputs |= ADI_FFT_OUT_DB;
+	if (outputs & ADI_FFT_OUT_DB)
+		outputs |= ADI_FFT_OUT_MAGNITUDE;
+
+	return outputs;
+}
+
+/**
+ * @brief Get the DC offset of the input data
+ * @param data[in] - Input data
+ * @param len[in] - Number of samples
+ * @return DC offset
+ * @note Same offset as computed by adi_fft_waveform_stat(), used when the
+ *	 waveform statistics are not computed.
+ */
+static int32_t adi_fft_get_dc_offset(const int32_t *data, uint16_t len)
+{
+	uint16_t cnt;
+	int64_t sum = 0;
+
+	for (cnt = 0; cnt < len; cnt++)
+		sum += data[cnt];
+
+	return (int32_t)(sum / len);
+}
+
+/**
+ * @brief Perform the FFT of a record with fractional codes
+ * @param fft_proc[in,out] - FFT processing parameters, the input data being
+ *			     the codes rounded to the nearest integer
  * @param fft_meas[in,out] - FFT measurements parameters
+ * @param fraction[in] - Fractional part of the codes, -0.5 to 0.5, FFT length
+ *			 samples (NULL for integer codes)
  * @return 0 in case of success, negative error code otherwise
+ * @note Used for records computed with a resolution finer than the code,
+ *	 e.g. averaged records, whose rounding would raise the noise floor to
+ *	 the quantization noise. The fractional part is added when loading the
+ *	 FFT input, the waveform statistics being computed from the rounded
+ *	 codes. It is ignored with an input filter, which is applied to the
+ *	 rounded codes.
  */
-int adi_fft_perform(struct adi_fft_processing *fft_proc,
-		    struct adi_fft_measurements *fft_meas)
+int adi_fft_perform_fractional(struct adi_fft_processing *fft_proc,
+			       struct adi_fft_measurements *fft_meas,
+			       const float *fraction)
 {
 	int ret;
-	uint32_t cnt;
-	uint32_t sample_cnt;
+	int32_t offset;
 	double coeffs_sum = 0.0;
+	uint8_t outputs;
 
 	if (!fft_proc || !fft_meas)
 		return -EINVAL;
 
+	outputs = adi_fft_resolve_outputs(fft_proc->outputs);
 	fft_proc->fft_done = false;
 	fft_proc->bin_width = (float)fft_proc->sample_rate / fft_proc->fft_length;
 
+	/* Condition the input data (e.g. low-pass or mains notch filtering) */
+	if (fft_proc->input_filter) {
+		ret = fft_proc->input_filter(fft_proc->input_data, fft_proc->fft_length,
+					     fft_proc->input_filter_ctx);
+		if (ret)
+			return ret;
+
+		fraction = NULL;
+	}
+
 	/* Perform DC characterization */
-	ret = adi_fft_waveform_stat(fft_proc, fft_meas);
+	if (outputs & ADI_FFT_OUT_WAVEFORM_STATS) {
+		ret = adi_fft_waveform_stat(fft_proc, fft_meas, &offset);
+		if (ret)
+			return ret;
+	} else
+		offset = adi_fft_get_dc_offset(fft_proc->input_data, fft_proc->fft_length);
+
+	if (!(outputs & ADI_FFT_OUT_MAGNITUDE)) {
+		fft_proc->fft_done = true;
+		return 0;
+	}
+
+	/* Remove DC offset, convert to volts and apply windowing */
+	ret = adi_fft_load_input(fft_proc, fft_proc->input_data, fraction,
+				 fft_proc->fft_input, offset, &coeffs_sum);
 	if (ret)
 		return ret;
 
-	/* Convert codes without DC offset to "volts" without respect to Vref voltage */
-	sample_cnt = 0;
-	for (cnt = 0; cnt < fft_proc->fft_length * 2; cnt+=2) {
-		/* Real part */
-		fft_proc->fft_input[cnt] = fft_proc->cnv_data_to_volt_without_vref(
-						   fft_proc->input_data[sample_cnt], 0);
+	ret = adi_fft_run(fft_proc, fft_proc->fft_input);
+	if (ret)
+		return ret;
 
-		/* Imaginary part (always zero for complex FFT) */
-		fft_proc->fft_input[cnt+1] = 0;
+	/* Perform AC characterization */
+	ret = adi_fft_store_spectrum(fft_proc, coeffs_sum,
+				     outputs & ADI_FFT_OUT_DB);
+	if (ret)
+		return ret;
 
-		sample_cnt++;
+	if (outputs & ADI_FFT_OUT_THD) {
+		ret = adi_fft_calculate_thd(fft_proc, fft_meas);
+		if (ret)
+			return ret;
 	}
 
-	/* Apply windowing */
-	ret = adi_fft_windowing(fft_proc, &coeffs_sum);
-	if (ret)
-		return ret;
+	if (outputs & ADI_FFT_OUT_NOISE) {
+		ret = adi_fft_calculate_noise(fft_proc, fft_meas);
+		if (ret)
+			return ret;
+	}
 
-	/* Perform the FFT through CMSIS-DSP support libraries */
-	arm_cfft_f32(&cfft_instance, fft_proc->fft_input, 0, 1);
+	fft_proc->fft_done = true;
 
-	/* Transform from complex FFT to magnitude */
-	arm_cmplx_mag_f32(fft_proc->fft_input, fft_proc->fft_magnitude,
-			  fft_proc->fft_length);
+	return 0;
+}
 
-	/* Perform AC characterization */
-	ret = adi_fft_magnitude_to_db(fft_proc, coeffs_sum);
+/**
+ * @brief Perform the FFT
+ * @param fft_proc[in,out] - FFT processing parameters
+ * @param fft_meas[in,out] - FFT measurements parameters
+ * @return 0 in case of success, negative error code otherwise
+ */
+int adi_fft_perform(struct adi_fft_processing *fft_proc,
+		    struct adi_fft_measurements *fft_meas)
+{
+	return adi_fft_perform_fractional(fft_proc, fft_meas, NULL);
+}
+
+/**
+ * @brief Recalculate the measurements from the spectrum of the last FFT
+ * @param fft_proc[in,out] - FFT processing parameters
+ * @param fft_meas[in,out] - FFT measurements parameters
+ * @return 0 in case of success, negative error code otherwise
+ * @note Only the spectrum analysis (THD, noise) is run again, e.g. after
+ *	 changing the DC, fundamental or harmonics bins of fft_proc. The
+ *	 waveform measurements of the last adi_fft_perform() are kept. The
+ *	 spectrum in dB must have been computed (see ADI_FFT_OUT_DB).
+ */
+int adi_fft_reanalyze(struct adi_fft_processing *fft_proc,
+		      struct adi_fft_measurements *fft_meas)
+{
+	int ret;
+
+	if (!fft_proc || !fft_meas || !fft_proc->fft_done
+	    || !(adi_fft_resolve_outputs(fft_proc->outputs) & ADI_FFT_OUT_DB))
+		return -EINVAL;
+
+	ret = adi_fft_calculate_thd(fft_proc, fft_meas);
 	if (ret)
 		return ret;
 
-	ret = adi_fft_calculate_thd(fft_proc, fft_meas);
+	return adi_fft_calculate_noise(fft_proc, fft_meas);
+}
+
+/**
+ * @brief Compute the complex spectrum of a data record
+ * @param fft_proc[in] - FFT processing parameters (length, window, conversion)
+ * @param data[in] - Input data (straight binary for ADCs), FFT length samples
+ * @param spectrum[out] - Complex spectrum, FFT length complex interleaved bins
+ * @param gain[out] - Amplitude correction of the spectrum, turning the bins
+ *		      magnitude into volts without respect to Vref (optional)
+ * @return 0 in case of success, negative error code otherwise
+ * @note The DC offset is removed and the window applied as for
+ *	 adi_fft_perform(), the FFT plan being shared with it. The input filter
+ *	 is not applied and fft_proc buffers are not modified.
+ */
+int adi_fft_compute_spectrum(struct adi_fft_processing *fft_proc,
+			     const int32_t *data, float *spectrum, float *gain)
+{
+	int ret;
+	double coeffs_sum = 0.0;
+	float coeff_sum;
+
+	if (!fft_proc || !data || !spectrum || !fft_proc->fft_length)
+		return -EINVAL;
+
+	ret = adi_fft_load_input(fft_proc, data, NULL, spectrum,
+				 adi_fft_get_dc_offset(data, fft_proc->fft_length), &coeffs_sum);
 	if (ret)
 		return ret;
 
-	ret = adi_fft_calculate_noise(fft_proc, fft_meas);
+	ret = adi_fft_run(fft_proc, spectrum);
 	if (ret)
 		return ret;
 
-	fft_proc->fft_done = true;
+	if (gain) {
+		ret = adi_fft_window_sum(fft_proc, coeffs_sum, &coeff_sum);
+		if (ret)
+			return ret;
+
+		*gain = 2.0 / coeff_sum;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Unpack the samples of a raw data buffer
+ * @param format[in] - Format of the samples in the buffer
+ * @param cnv_code[in] - Device code conversion (optional)
+ * @param buf[in] - Raw data buffer, first sample of the channel
+ * @param count[in] - Number of samples to be unpacked
+ * @param data[out] - Straight binary data, count samples
+ * @return 0 in case of success, negative error code otherwise
+ * @note Without code conversion, the samples are read with the endianness of
+ *	 the format, shifted, masked, sign extended and offset. A device code
+ *	 conversion is given the stored sample in native byte order, as copied
+ *	 out of the buffer, the conversion handling the sample format itself.
+ */
+int adi_fft_unpack_raw(const struct adi_fft_raw_format *format,
+		       adi_fft_code_to_straight_bin_conv cnv_code,
+		       const uint8_t *buf, uint16_t count, int32_t *data)
+{
+	const uint8_t bytes = format ? format->storagebits >> 3 : 0;
+	const uint16_t stride = (format && format->stride) ? format->stride : bytes;
+	const uint32_t sign_bit = format ? (uint32_t)1 << (format->realbits - 1) : 0;
+	const uint32_t mask = sign_bit ? (sign_bit << 1) - 1 : 0;
+	const uint8_t *sample;
+	uint32_t word, code;
+	uint16_t cnt;
+	uint8_t byte;
+
+	if (!format || !buf || !data)
+		return -EINVAL;
+
+	if ((format->storagebits != 8 && format->storagebits != 16
+	     && format->storagebits != 24 && format->storagebits != 32)
+	    || !format->realbits
+	    || format->realbits + format->shift > format->storagebits)
+		return -EINVAL;
+
+	if (cnv_code) {
+		for (cnt = 0, sample = buf; cnt < count; cnt++, sample += stride) {
+			word = 0;
+			memcpy(&word, sample, bytes);
+			data[cnt] = cnv_code(word, format->chn);
+		}
+
+		return 0;
+	}
+
+	for (cnt = 0, sample = buf; cnt < count; cnt++, sample += stride) {
+		word = 0;
+		if (format->is_big_endian)
+			for (byte = 0; byte < bytes; byte++)
+				word = (word << 8) | sample[byte];
+		else
+			for (byte = bytes; byte-- > 0;)
+				word = (word << 8) | sample[byte];
+
+		code = (word >> format->shift) & mask;
+		if (format->sign == 's')
+			/* Sign extension of the valid bits */
+			data[cnt] = (int32_t)((code ^ sign_bit) - sign_bit) + format->offset;
+		else
+			data[cnt] = (int32_t)code + format->offset;
+	}
 
 	return 0;
 }
+
+/**
+ * @brief Load samples of a raw data buffer into the input data
+ * @param fft_proc[in,out] - FFT processing parameters
+ * @param format[in] - Format of the samples in the buffer
+ * @param buf[in] - Raw data buffer, first sample of the channel
+ * @param first[in] - Index of the first input data sample to be loaded, so
+ *		      that a record can be loaded from several buffers
+ * @param count[in] - Number of samples to be loaded
+ * @return 0 in case of success, negative error code otherwise
+ * @note The samples are unpacked and converted to straight binary (see
+ *	 adi_fft_unpack_raw()) with the code conversion of the FFT processing,
+ *	 in a single pass over the buffer received from the device. They are
+ *	 still expanded into the int32 input data, read again by
+ *	 adi_fft_perform(): records arrive split over several buffers, and the
+ *	 input filter, the synchronous averaging and the users of the input
+ *	 data work on the int32 record.
+ */
+int adi_fft_load_raw(struct adi_fft_processing *fft_proc,
+		     const struct adi_fft_raw_format *format,
+		     const uint8_t *buf, uint16_t first, uint16_t count)
+{
+	if (!fft_proc || (uint32_t)first + count > fft_proc->fft_length)
+		return -EINVAL;
+
+	return adi_fft_unpack_raw(format, fft_proc->cnv_code_to_straight_binary,
+				  buf, count, &fft_proc->input_data[first]);
+}
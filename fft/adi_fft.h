@@ -26,19 +26,58 @@
 /******************************************************************************/
 
 /* Maximum number of default samples used for FFT analysis (must be <=2048)
- * FFT length = FFT samples. FFT length(samples) are supported only as power of 2
- * e.g. 512, 1024, 2048
+ * FFT length = FFT samples. Power of 2 lengths (e.g. 512, 1024, 2048) are the
+ * fastest, other lengths (e.g. 1000, 2000) are computed with mixed radix
+ * stages or with the Bluestein algorithm (see adi_fft_mixed_radix.h)
  * */
 #if !defined(ADI_FFT_MAX_SAMPLES)
 #define ADI_FFT_MAX_SAMPLES		2048
 #endif
 
+/* Define ADI_FFT_MINIMAL_MEMORY to run the FFT pipeline in place: the input
+ * data, the FFT input and the magnitudes share a single buffer and the
+ * spectrum in dB is computed on demand, cutting the memory used by an
+ * adi_fft_processing instance by more than half */
+
+/* Default count of DC bins ignored for noise and other calculations */
+#if !defined(ADI_FFT_DC_BINS)
+#define ADI_FFT_DC_BINS		10
+#endif
+
+/* Default power spread of the fundamental, bins from either side of it */
+#if !defined(ADI_FFT_FUND_BINS)
+#define ADI_FFT_FUND_BINS	10
+#endif
+
+/* Default power spread of the harmonics, bins from either side of them */
+#if !defined(ADI_FFT_HARM_BINS)
+#define ADI_FFT_HARM_BINS	3
+#endif
+
+/* Max number of spurs reported by the noise analysis, highest first */
+#if !defined(ADI_FFT_MAX_SPURS)
+#define ADI_FFT_MAX_SPURS	8
+#endif
+
+/* Outputs of the FFT processing, selected with the outputs bitmask.
+ * Dependencies are computed as well: noise (SNR, DR, SINAD, ENOB) needs
+ * THD, which needs the spectrum in dB, which needs the magnitude */
+#define ADI_FFT_OUT_WAVEFORM_STATS	(1 << 0)
+#define ADI_FFT_OUT_MAGNITUDE		(1 << 1)
+#define ADI_FFT_OUT_DB			(1 << 2)
+#define ADI_FFT_OUT_THD			(1 << 3)
+#define ADI_FFT_OUT_NOISE		(1 << 4)
+#define ADI_FFT_OUT_ALL			(ADI_FFT_OUT_WAVEFORM_STATS | \
+					 ADI_FFT_OUT_MAGNITUDE | ADI_FFT_OUT_DB | \
+					 ADI_FFT_OUT_THD | ADI_FFT_OUT_NOISE)
+
 /******************************************************************************/
 /************************ Public Declarations *********************************/
 /******************************************************************************/
 
 typedef float(*adi_fft_data_to_volt_conv)(int32_t, uint8_t);
 typedef int32_t(*adi_fft_code_to_straight_bin_conv)(uint32_t, uint8_t);
+typedef int(*adi_fft_input_filter)(int32_t *, uint16_t, void *);
 
 /* FFT windowing type */
 enum adi_fft_windowing_type {
@@ -46,6 +85,29 @@ enum adi_fft_windowing_type {
 	RECTANGULAR
 };
 
+/* Format of the samples of a raw (packed) data buffer, following the IIO
+ * scan type of the channel */
+struct adi_fft_raw_format {
+	/* 's' for two's complement samples, 'u' for unsigned samples */
+	char sign;
+	/* Valid bits of a sample */
+	uint8_t realbits;
+	/* Bits used to store a sample: 8, 16, 24 or 32 */
+	uint8_t storagebits;
+	/* Right shift of the valid bits within the stored sample */
+	uint8_t shift;
+	/* Samples stored big endian (ignored by the device code conversions,
+	 * given the samples in native byte order) */
+	bool is_big_endian;
+	/* Bytes from a sample of the channel to the next one, storagebits / 8
+	 * when only the channel is in the buffer (0 = storagebits / 8) */
+	uint16_t stride;
+	/* Offset added to the samples to get straight binary data */
+	int32_t offset;
+	/* Channel passed to the code conversion */
+	uint8_t chn;
+};
+
 /* FFT init parameters specific to device */
 struct adi_fft_init_params {
 	/* Device reference voltage */
@@ -64,6 +126,10 @@ struct adi_fft_init_params {
 	adi_fft_data_to_volt_conv convert_data_to_volt_wrt_vref;
 	/* Convert code to straight binary data */
 	adi_fft_code_to_straight_bin_conv convert_code_to_straight_binary;
+	/* Filter applied to the input data before the analysis (optional) */
+	adi_fft_input_filter input_filter;
+	/* Context passed to the input filter */
+	void *input_filter_ctx;
 };
 
 /* FFT processing parameters */
@@ -82,10 +148,29 @@ struct adi_fft_processing {
 	adi_fft_data_to_volt_conv cnv_data_to_volt_wrt_vref;
 	/* Convert code to straight binary data */
 	adi_fft_code_to_straight_bin_conv cnv_code_to_straight_binary;
+	/* Filter applied to the input data before the analysis (optional) */
+	adi_fft_input_filter input_filter;
+	/* Context passed to the input filter */
+	void *input_filter_ctx;
 	/* FFT length */
 	uint16_t fft_length;
 	/* FFT bin width */
 	float bin_width;
+#if defined(ADI_FFT_MINIMAL_MEMORY)
+	/* Input data and FFT input share the same memory, the input data being
+	 * overwritten by the FFT */
+	union {
+		/* Input data (unformatted/straight binary for ADCs) */
+		int32_t input_data[ADI_FFT_MAX_SAMPLES];
+		/* Maximum length of FFT input array supporred - Real + Imaginary components */
+		float fft_input[ADI_FFT_MAX_SAMPLES * 2];
+	};
+	/* FFT magnitude, computed in place of the FFT input */
+	float *fft_magnitude;
+	/* Magnitude with windowing correction, computed in place of the magnitude.
+	 * FFT effective gain is computed on demand (see adi_fft_get_bin_db()) */
+	float *fft_magnitude_corrected;
+#else
 	/* Input data (unformatted/straight binary for ADCs) */
 	int32_t input_data[ADI_FFT_MAX_SAMPLES];
 	/* Maximum length of FFT magnitude */
@@ -98,12 +183,36 @@ struct adi_fft_processing {
 	float fft_input[ADI_FFT_MAX_SAMPLES * 2];
 	/* FFT bins excluding DC, fundamental and Harmonics */
 	float noise_bins[ADI_FFT_MAX_SAMPLES / 2];
+#endif
+	/* Number of DC bins ignored by the analysis */
+	uint16_t dc_bins;
+	/* Power spread of the fundamental, bins from either side of it */
+	uint16_t fund_bins;
+	/* Power spread of the harmonics, bins from either side of them */
+	uint16_t harm_bins;
 	/* FFT window type */
 	enum adi_fft_windowing_type window;
+	/* Number of spurs to be reported (<= ADI_FFT_MAX_SPURS) */
+	uint8_t max_spurs;
+	/* Bitmask of the outputs to be computed (ADI_FFT_OUT_x) */
+	uint8_t outputs;
 	/* FFT done status */
 	bool fft_done;
 };
 
+/* Spur of the spectrum, excluding DC, the fundamental and the harmonics.
+ * Adjacent bins leaked by a spur are merged into its peak bin */
+struct adi_fft_spur {
+	/* Bin of the spur peak */
+	uint16_t bin;
+	/* Frequency of the spur peak in Hz */
+	float freq;
+	/* Magnitude of the spur peak, dBFS */
+	float dbfs;
+	/* Magnitude of the spur peak related to the fundamental, dBc */
+	float dbc;
+};
+
 /* FFT meausurement parameters */
 struct adi_fft_measurements {
 	/* Harmonics, including their power leakage */
@@ -118,6 +227,10 @@ struct adi_fft_measurements {
 	float pk_spurious_noise;
 	/* Peak Spurious Frequency */
 	uint16_t pk_spurious_freq;
+	/* Highest spurs, sorted by decreasing magnitude */
+	struct adi_fft_spur spurs[ADI_FFT_MAX_SPURS];
+	/* Number of spurs found */
+	uint8_t spurs_count;
 	/* Total Harmonic Distortion */
 	float THD;
 	/* Signal to Noise Ratio */
@@ -164,5 +277,19 @@ int adi_fft_update_params(struct adi_fft_init_params *param,
 			  struct adi_fft_processing *fft_proc);
 int adi_fft_perform(struct adi_fft_processing *fft_proc,
 		    struct adi_fft_measurements *fft_meas);
+int adi_fft_perform_fractional(struct adi_fft_processing *fft_proc,
+			       struct adi_fft_measurements *fft_meas,
+			       const float *fraction);
+int adi_fft_reanalyze(struct adi_fft_processing *fft_proc,
+		      struct adi_fft_measurements *fft_meas);
+float adi_fft_get_bin_db(struct adi_fft_processing *fft_proc, uint16_t bin);
+int adi_fft_compute_spectrum(struct adi_fft_processing *fft_proc,
+			     const int32_t *data, float *spectrum, float *gain);
+int adi_fft_unpack_raw(const struct adi_fft_raw_format *format,
+		       adi_fft_code_to_straight_bin_conv cnv_code,
+		       const uint8_t *buf, uint16_t count, int32_t *data);
+int adi_fft_load_raw(struct adi_fft_processing *fft_proc,
+		     const struct adi_fft_raw_format *format,
+		     const uint8_t *buf, uint16_t first, uint16_t count);
 
 #endif // !_ADI_FFT_H_
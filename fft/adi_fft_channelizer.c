@@ -0,0 +1,242 @@
+/***************************************************************************//**
+ *   @file    adi_fft_channelizer.c
+ *   @brief   Polyphase filter bank channelizer implementation
+ *   @details Splits the input stream into M uniform channels decimated by M
+ *	      (critically sampled DFT filter bank). Every M input samples, the
+ *	      M polyphase branches of a windowed sinc prototype lowpass are
+ *	      summed and a single M points FFT outputs one sample of each
+ *	      channel, from which the channels power is updated.
+********************************************************************************
+ * Copyright (c) 2024 Analog Devices, Inc.
+ *
+ * This software is proprietary to Analog Devices, Inc. and its licensors.
+ * By using this software you agree to the terms of the associated
+ * Analog Devices Software License Agreement.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+#include "adi_fft_channelizer.h"
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Compute the prototype lowpass filter
+ * @param desc[in,out] - Channelizer descriptor
+ * @return none
+ * @note Blackman windowed sinc, cut-off at half the channel spacing and unity
+ *	 gain at DC, so that adjacent channels cross at -6 dB.
+ */
+static void adi_fft_channelizer_design(struct adi_fft_channelizer *desc)
+{
+	const uint32_t taps = (uint32_t)desc->num_channels * desc->taps_per_phase;
+	const double center = (taps - 1) / 2.0;
+	double sum = 0.0, n, term;
+	uint32_t cnt;
+
+	for (cnt = 0; cnt < taps; cnt++) {
+		n = (cnt - center) / desc->num_channels;
+		term = (n != 0.0) ? sin(PI * n) / (PI * n) : 1.0;
+		term *= 0.42 - 0.5 * cos(2.0 * PI * cnt / (taps - 1)) +
+			0.08 * cos(4.0 * PI * cnt / (taps - 1));
+		desc->coeffs[cnt] = term;
+		sum += term;
+	}
+
+	for (cnt = 0; cnt < taps; cnt++)
+		desc->coeffs[cnt] /= sum;
+}
+
+/**
+ * @brief Initialize the channelizer
+ * @param desc[out] - Channelizer descriptor
+ * @param param[in] - Channelizer init parameters
+ * @return 0 in case of success, negative error code otherwise
+ */
+int adi_fft_channelizer_init(struct adi_fft_channelizer **desc,
+			     const struct adi_fft_channelizer_init_param *param)
+{
+	struct adi_fft_channelizer *chan;
+	uint32_t taps;
+
+	if (!desc || !param || param->avg_alpha <= 0 || param->avg_alpha > 1)
+		return -EINVAL;
+
+	chan = calloc(1, sizeof(*chan));
+	if (!chan)
+		return -ENOMEM;
+
+	if (arm_cfft_init_f32(&chan->cfft_instance, param->num_channels)) {
+		free(chan);
+		return -EINVAL;
+	}
+
+	chan->num_channels = param->num_channels;
+	chan->taps_per_phase = param->taps_per_phase ? param->taps_per_phase :
+			       ADI_FFT_CHANNELIZER_TAPS_PER_PHASE;
+	chan->avg_alpha = param->avg_alpha;
+	chan->convert_data_to_volt = param->convert_data_to_volt;
+	chan->chn = param->chn;
+	chan->publish = param->publish;
+	chan->publish_ctx = param->publish_ctx;
+
+	taps = (uint32_t)chan->num_channels * chan->taps_per_phase;
+	chan->coeffs = calloc(taps, sizeof(float));
+	chan->delay = calloc(taps, sizeof(float));
+	chan->block = calloc(chan->num_channels, sizeof(float));
+	chan->fft_buf = calloc(2 * chan->num_channels, sizeof(float));
+	chan->power = calloc(chan->num_channels / 2 + 1, sizeof(float));
+	if (!chan->coeffs || !chan->delay || !chan->block || !chan->fft_buf
+	    || !chan->power) {
+		adi_fft_channelizer_remove(chan);
+		return -ENOMEM;
+	}
+
+	adi_fft_channelizer_design(chan);
+
+	*desc = chan;
+
+	return 0;
+}
+
+/**
+ * @brief Free the resources allocated by adi_fft_channelizer_init()
+ * @param desc[in] - Channelizer descriptor
+ * @return 0 in case of success, negative error code otherwise
+ */
+int adi_fft_channelizer_remove(struct adi_fft_channelizer *desc)
+{
+	if (!desc)
+		return -EINVAL;
+
+	free(desc->coeffs);
+	free(desc->delay);
+	free(desc->block);
+	free(desc->fft_buf);
+	free(desc->power);
+	free(desc);
+
+	return 0;
+}
+
+/**
+ * @brief Clear the input history and the channels power
+ * @param desc[in,out] - Channelizer descriptor
+ * @return none
+ */
+void adi_fft_channelizer_reset(struct adi_fft_channelizer *desc)
+{
+	if (!desc)
+		return;
+
+	memset(desc->delay, 0, (uint32_t)desc->num_channels * desc->taps_per_phase *
+	       sizeof(float));
+	memset(desc->power, 0, (desc->num_channels / 2 + 1) * sizeof(float));
+	desc->fill = 0;
+	desc->blocks = 0;
+}
+
+/**
+ * @brief Output one sample of each channel and update the channels power
+ * @param desc[in,out] - Channelizer descriptor
+ * @return none
+ */
+static void adi_fft_channelizer_block(struct adi_fft_channelizer *desc)
+{
+	const uint16_t m = desc->num_channels;
+	const uint32_t taps = (uint32_t)m * desc->taps_per_phase;
+	const float alpha = desc->blocks ? desc->avg_alpha : 1.0;
+	float sum, re, im, power;
+	uint32_t cnt, tap;
+
+	/* Shift the history by a block, the newest sample first */
+	memmove(&desc->delay[m], desc->delay, (taps - m) * sizeof(float));
+	for (cnt = 0; cnt < m; cnt++)
+		desc->delay[cnt] = desc->block[m - 1 - cnt];
+
+	/* Polyphase branches */
+	for (cnt = 0; cnt < m; cnt++) {
+		sum = 0.0;
+		for (tap = cnt; tap < taps; tap += m)
+			sum += desc->coeffs[tap] * desc->delay[tap];
+		desc->fft_buf[2 * cnt] = sum;
+		desc->fft_buf[2 * cnt + 1] = 0.0;
+	}
+
+	arm_cfft_f32(&desc->cfft_instance, desc->fft_buf, 0, 1);
+
+	/* Power of the channels, both sides of the spectrum for a real input */
+	for (cnt = 0; cnt <= m / 2; cnt++) {
+		re = desc->fft_buf[2 * cnt];
+		im = desc->fft_buf[2 * cnt + 1];
+		power = re * re + im * im;
+		if (cnt && cnt < m / 2)
+			power *= 2.0;
+		desc->power[cnt] += alpha * (power - desc->power[cnt]);
+	}
+
+	desc->blocks++;
+
+	if (desc->publish)
+		desc->publish(desc->power, m / 2 + 1, desc->publish_ctx);
+}
+
+/**
+ * @brief Process input data
+ * @param desc[in,out] - Channelizer descriptor
+ * @param data[in] - Input data (straight binary for ADCs)
+ * @param len[in] - Number of samples, any length, the channels power being
+ *		    updated every num_channels samples
+ * @return 0 in case of success, negative error code otherwise
+ */
+int adi_fft_channelizer_process(struct adi_fft_channelizer *desc,
+				const int32_t *data, uint32_t len)
+{
+	uint32_t cnt;
+
+	if (!desc || !data)
+		return -EINVAL;
+
+	for (cnt = 0; cnt < len; cnt++) {
+		if (desc->convert_data_to_volt)
+			desc->block[desc->fill] = desc->convert_data_to_volt(data[cnt], desc->chn);
+		else
+			desc->block[desc->fill] = data[cnt];
+
+		if (++desc->fill == desc->num_channels) {
+			adi_fft_channelizer_block(desc);
+			desc->fill = 0;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Get the power of a channel
+ * @param desc[in] - Channelizer descriptor
+ * @param channel[in] - Channel, 0 to num_channels / 2
+ * @param power[out] - Averaged power of the channel, V^2 or codes^2
+ * @return 0 in case of success, negative error code otherwise
+ */
+int adi_fft_channelizer_get_power(struct adi_fft_channelizer *desc,
+				  uint16_t channel, float *power)
+{
+	if (!desc || !power || channel > desc->num_channels / 2)
+		return -EINVAL;
+
+	if (!desc->blocks)
+		return -EAGAIN;
+
+	*power = desc->power[channel];
+
+	return 0;
+}
@@ -0,0 +1,104 @@
+/*************************************************************************//**
+ *   @file   adi_fft_channelizer.h
+ *   @brief  Polyphase filter bank channelizer headers
+******************************************************************************
+* Copyright (c) 2024 Analog Devices, Inc.
+* All rights reserved.
+*
+* This software is proprietary to Analog Devices, Inc. and its licensors.
+* By using this software you agree to the terms of the associated
+* Analog Devices Software License Agreement.
+*****************************************************************************/
+
+#ifndef _ADI_FFT_CHANNELIZER_H_
+#define _ADI_FFT_CHANNELIZER_H_
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdint.h>
+#include <arm_math.h>
+#include "adi_fft.h"
+
+/******************************************************************************/
+/************************ Macros/Constants ************************************/
+/******************************************************************************/
+
+/* Default number of prototype filter taps per channel (polyphase branch) */
+#if !defined(ADI_FFT_CHANNELIZER_TAPS_PER_PHASE)
+#define ADI_FFT_CHANNELIZER_TAPS_PER_PHASE	8
+#endif
+
+/******************************************************************************/
+/************************ Public Declarations *********************************/
+/******************************************************************************/
+
+typedef void(*adi_fft_channelizer_publish)(const float *, uint16_t, void *);
+
+/* Channelizer init parameters */
+struct adi_fft_channelizer_init_param {
+	/* Number of uniform channels M, power of 2 supported by the CMSIS-DSP
+	 * CFFT. Channel k is centered on k * fs / M */
+	uint16_t num_channels;
+	/* Prototype filter taps per channel, default if 0 */
+	uint8_t taps_per_phase;
+	/* Exponential averaging of the channels power (0 to 1), 1 for the power
+	 * of the last block only */
+	float avg_alpha;
+	/* Convert the input data to volts, same as the FFT library (optional,
+	 * power is in codes^2 if not set) */
+	adi_fft_data_to_volt_conv convert_data_to_volt;
+	/* Channel passed to the conversion function */
+	uint8_t chn;
+	/* Called with the channels power after each block (optional) */
+	adi_fft_channelizer_publish publish;
+	/* Context passed to the publish callback */
+	void *publish_ctx;
+};
+
+/* Channelizer descriptor */
+struct adi_fft_channelizer {
+	/* Number of channels */
+	uint16_t num_channels;
+	/* Prototype filter taps per channel */
+	uint8_t taps_per_phase;
+	/* Exponential averaging of the channels power */
+	float avg_alpha;
+	/* Convert the input data to volts */
+	adi_fft_data_to_volt_conv convert_data_to_volt;
+	/* Channel passed to the conversion function */
+	uint8_t chn;
+	/* Channels power callback */
+	adi_fft_channelizer_publish publish;
+	/* Context passed to the publish callback */
+	void *publish_ctx;
+	/* Prototype lowpass filter, num_channels * taps_per_phase taps */
+	float *coeffs;
+	/* Input history, newest sample first */
+	float *delay;
+	/* Input samples of the block being filled */
+	float *block;
+	/* Number of samples in the block */
+	uint16_t fill;
+	/* Polyphase branches output and FFT, complex interleaved */
+	float *fft_buf;
+	/* Power of the channels 0 to num_channels / 2 (real input), V^2 or
+	 * codes^2 */
+	float *power;
+	/* Number of processed blocks */
+	uint32_t blocks;
+	/* Instance of the CMSIS-DSP CFFT */
+	arm_cfft_instance_f32 cfft_instance;
+};
+
+int adi_fft_channelizer_init(struct adi_fft_channelizer **desc,
+			     const struct adi_fft_channelizer_init_param *param);
+int adi_fft_channelizer_remove(struct adi_fft_channelizer *desc);
+void adi_fft_channelizer_reset(struct adi_fft_channelizer *desc);
+int adi_fft_channelizer_process(struct adi_fft_channelizer *desc,
+				const int32_t *data, uint32_t len);
+int adi_fft_channelizer_get_power(struct adi_fft_channelizer *desc,
+				  uint16_t channel, float *power);
+
+#endif	// !_ADI_FFT_CHANNELIZER_H_
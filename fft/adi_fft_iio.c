@@ -0,0 +1,330 @@
+/***************************************************************************//**
+ *   @file    adi_fft_iio.c
+ *   @brief   FFT results IIO device implementation
+ *   @details Exports the results of the FFT processing, as published to an
+ *	      adi_fft_snapshot, through the IIOD transport. The measurements
+ *	      are device attributes and the spectrum is streamed by the
+ *	      buffered "magnitude" channel, one scan per bin in dB x 1000.
+ *	      The host gets the analysis results instead of the raw data,
+ *	      e.g. 1024 scans per spectrum of a 2048 points FFT.
+********************************************************************************
+ * Copyright (c) 2024 Analog Devices, Inc.
+ *
+ * This software is proprietary to Analog Devices, Inc. and its licensors.
+ * By using this software you agree to the terms of the associated
+ * Analog Devices Software License Agreement.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <errno.h>
+#include "adi_fft_iio.h"
+#include "no_os_util.h"
+
+/******************************************************************************/
+/******************** Variables and User Defined Data Types *******************/
+/******************************************************************************/
+
+/* FFT results exported as attributes */
+enum adi_fft_iio_attr_id {
+	ADI_FFT_IIO_THD,
+	ADI_FFT_IIO_SNR,
+	ADI_FFT_IIO_DR,
+	ADI_FFT_IIO_SINAD,
+	ADI_FFT_IIO_SFDR_DBC,
+	ADI_FFT_IIO_SFDR_DBFS,
+	ADI_FFT_IIO_ENOB,
+	ADI_FFT_IIO_RMS_NOISE,
+	ADI_FFT_IIO_FUND_FREQ,
+	ADI_FFT_IIO_FUND_DBFS,
+	ADI_FFT_IIO_DC,
+	ADI_FFT_IIO_PK_PK_AMPLITUDE,
+	ADI_FFT_IIO_SAMPLE_RATE,
+	ADI_FFT_IIO_FFT_LENGTH,
+	ADI_FFT_IIO_BIN_WIDTH,
+	ADI_FFT_IIO_SPECTRUM_BINS,
+	ADI_FFT_IIO_SPECTRUM_DECIMATION,
+	ADI_FFT_IIO_SEQUENCE,
+	ADI_FFT_IIO_SCALE
+};
+
+static int adi_fft_iio_attr_show(void *device, char *buf, uint32_t len,
+				 const struct iio_ch_info *channel, intptr_t priv);
+
+/* Device attributes, measurements of the latest FFT (dB, volts, Hz) */
+static struct iio_attribute adi_fft_iio_attributes[] = {
+	{ .name = "thd", .show = adi_fft_iio_attr_show, .priv = ADI_FFT_IIO_THD },
+	{ .name = "snr", .show = adi_fft_iio_attr_show, .priv = ADI_FFT_IIO_SNR },
+	{ .name = "dr", .show = adi_fft_iio_attr_show, .priv = ADI_FFT_IIO_DR },
+	{ .name = "sinad", .show = adi_fft_iio_attr_show, .priv = ADI_FFT_IIO_SINAD },
+	{ .name = "sfdr_dbc", .show = adi_fft_iio_attr_show, .priv = ADI_FFT_IIO_SFDR_DBC },
+	{ .name = "sfdr_dbfs", .show = adi_fft_iio_attr_show, .priv = ADI_FFT_IIO_SFDR_DBFS },
+	{ .name = "enob", .show = adi_fft_iio_attr_show, .priv = ADI_FFT_IIO_ENOB },
+	{ .name = "rms_noise", .show = adi_fft_iio_attr_show, .priv = ADI_FFT_IIO_RMS_NOISE },
+	{ .name = "fundamental_frequency", .show = adi_fft_iio_attr_show, .priv = ADI_FFT_IIO_FUND_FREQ },
+	{ .name = "fundamental_dbfs", .show = adi_fft_iio_attr_show, .priv = ADI_FFT_IIO_FUND_DBFS },
+	{ .name = "dc", .show = adi_fft_iio_attr_show, .priv = ADI_FFT_IIO_DC },
+	{ .name = "pk_pk_amplitude", .show = adi_fft_iio_attr_show, .priv = ADI_FFT_IIO_PK_PK_AMPLITUDE },
+	{ .name = "sampling_frequency", .show = adi_fft_iio_attr_show, .priv = ADI_FFT_IIO_SAMPLE_RATE },
+	{ .name = "fft_length", .show = adi_fft_iio_attr_show, .priv = ADI_FFT_IIO_FFT_LENGTH },
+	{ .name = "bin_width", .show = adi_fft_iio_attr_show, .priv = ADI_FFT_IIO_BIN_WIDTH },
+	{ .name = "spectrum_bins", .show = adi_fft_iio_attr_show, .priv = ADI_FFT_IIO_SPECTRUM_BINS },
+	{ .name = "spectrum_decimation", .show = adi_fft_iio_attr_show, .priv = ADI_FFT_IIO_SPECTRUM_DECIMATION },
+	{ .name = "sequence", .show = adi_fft_iio_attr_show, .priv = ADI_FFT_IIO_SEQUENCE },
+	END_ATTRIBUTES_ARRAY
+};
+
+/* Magnitude channel attributes */
+static struct iio_attribute adi_fft_iio_chn_attributes[] = {
+	{ .name = "scale", .show = adi_fft_iio_attr_show, .priv = ADI_FFT_IIO_SCALE },
+	END_ATTRIBUTES_ARRAY
+};
+
+/* Magnitude in dB x 1000 */
+static struct scan_type adi_fft_iio_scan_type = {
+	.sign = 's',
+	.realbits = 32,
+	.storagebits = 32,
+	.shift = 0,
+	.is_big_endian = false
+};
+
+static struct iio_channel adi_fft_iio_channels[] = {
+	{
+		.name = "magnitude",
+		.ch_type = IIO_VOLTAGE,
+		.channel = 0,
+		.scan_index = 0,
+		.scan_type = &adi_fft_iio_scan_type,
+		.attributes = adi_fft_iio_chn_attributes,
+		.ch_out = false,
+		.indexed = true
+	}
+};
+
+static int32_t adi_fft_iio_pre_enable(void *dev, uint32_t mask);
+static int32_t adi_fft_iio_post_disable(void *dev);
+static int32_t adi_fft_iio_submit(struct iio_device_data *iio_dev_data);
+
+/* FFT IIO device */
+static struct iio_device adi_fft_iio_device = {
+	.num_ch = NO_OS_ARRAY_SIZE(adi_fft_iio_channels),
+	.channels = adi_fft_iio_channels,
+	.attributes = adi_fft_iio_attributes,
+	.pre_enable = adi_fft_iio_pre_enable,
+	.post_disable = adi_fft_iio_post_disable,
+	.submit = adi_fft_iio_submit
+};
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Read an FFT result attribute
+ * @param device[in] - FFT IIO device descriptor
+ * @param buf[out] - Attribute value
+ * @param len[in] - Length of the buffer
+ * @param channel[in] - Channel info
+ * @param priv[in] - Attribute ID
+ * @return Number of characters written in case of success, negative error
+ *	   code otherwise
+ * @note The latest FFT results are read, unless a spectrum is being streamed,
+ *	 in which case the results of the streamed spectrum are shown.
+ */
+static int adi_fft_iio_attr_show(void *device, char *buf, uint32_t len,
+				 const struct iio_ch_info *channel, intptr_t priv)
+{
+	struct adi_fft_iio_desc *desc = device;
+	const struct adi_fft_measurements *meas;
+	int ret;
+
+	if (!desc || !buf)
+		return -EINVAL;
+
+	if (priv == ADI_FFT_IIO_SCALE)
+		return snprintf(buf, len, "%f", ADI_FFT_IIO_MAGNITUDE_SCALE);
+
+	if (!desc->bin) {
+		ret = adi_fft_snapshot_read(desc->snapshot, &desc->data);
+		if (ret)
+			return ret;
+	}
+
+	meas = &desc->data.meas;
+
+	switch (priv) {
+	case ADI_FFT_IIO_THD:
+		return snprintf(buf, len, "%f", meas->THD);
+	case ADI_FFT_IIO_SNR:
+		return snprintf(buf, len, "%f", meas->SNR);
+	case ADI_FFT_IIO_DR:
+		return snprintf(buf, len, "%f", meas->DR);
+	case ADI_FFT_IIO_SINAD:
+		return snprintf(buf, len, "%f", meas->SINAD);
+	case ADI_FFT_IIO_SFDR_DBC:
+		return snprintf(buf, len, "%f", meas->SFDR_dbc);
+	case ADI_FFT_IIO_SFDR_DBFS:
+		return snprintf(buf, len, "%f", meas->SFDR_dbfs);
+	case ADI_FFT_IIO_ENOB:
+		return snprintf(buf, len, "%f", meas->ENOB);
+	case ADI_FFT_IIO_RMS_NOISE:
+		return snprintf(buf, len, "%e", meas->RMS_noise);
+	case ADI_FFT_IIO_FUND_FREQ:
+		return snprintf(buf, len, "%f",
+				meas->harmonics_freq[0] * desc->data.bin_width);
+	case ADI_FFT_IIO_FUND_DBFS:
+		return snprintf(buf, len, "%f", meas->harmonics_mag_dbfs[0]);
+	case ADI_FFT_IIO_DC:
+		return snprintf(buf, len, "%f", meas->DC);
+	case ADI_FFT_IIO_PK_PK_AMPLITUDE:
+		return snprintf(buf, len, "%f", meas->pk_pk_amplitude);
+	case ADI_FFT_IIO_SAMPLE_RATE:
+		return snprintf(buf, len, "%lu", (unsigned long)desc->data.sample_rate);
+	case ADI_FFT_IIO_FFT_LENGTH:
+		return snprintf(buf, len, "%u", desc->data.fft_length);
+	case ADI_FFT_IIO_BIN_WIDTH:
+		return snprintf(buf, len, "%f", desc->data.bin_width);
+	case ADI_FFT_IIO_SPECTRUM_BINS:
+		return snprintf(buf, len, "%u", desc->data.num_bins);
+	case ADI_FFT_IIO_SPECTRUM_DECIMATION:
+		return snprintf(buf, len, "%u", desc->data.decimation);
+	case ADI_FFT_IIO_SEQUENCE:
+		return snprintf(buf, len, "%lu", (unsigned long)desc->data.sequence);
+	default:
+		return -EINVAL;
+	}
+}
+
+/**
+ * @brief Prepare the streaming of the spectrum
+ * @param dev[in] - FFT IIO device descriptor
+ * @param mask[in] - Channels mask
+ * @return 0 in case of success, negative error code otherwise
+ */
+static int32_t adi_fft_iio_pre_enable(void *dev, uint32_t mask)
+{
+	struct adi_fft_iio_desc *desc = dev;
+
+	if (!desc || !(mask & NO_OS_BIT(0)))
+		return -EINVAL;
+
+	/* Streaming starts with the first bin of the latest spectrum */
+	desc->bin = 0;
+
+	return 0;
+}
+
+/**
+ * @brief End the streaming of the spectrum
+ * @param dev[in] - FFT IIO device descriptor
+ * @return 0 in case of success, negative error code otherwise
+ */
+static int32_t adi_fft_iio_post_disable(void *dev)
+{
+	struct adi_fft_iio_desc *desc = dev;
+
+	if (!desc)
+		return -EINVAL;
+
+	/* Attributes back to the latest FFT results */
+	desc->bin = 0;
+
+	return 0;
+}
+
+/**
+ * @brief Stream the spectrum of the latest FFT results
+ * @param iio_dev_data[in] - IIO device data
+ * @return 0 in case of success, negative error code otherwise
+ * @note The bins of a spectrum are streamed in a row, a new snapshot being
+ *	 read at the start of each spectrum. The sequence attribute tells the
+ *	 host whether a spectrum is new or a copy of the previous one.
+ */
+static int32_t adi_fft_iio_submit(struct iio_device_data *iio_dev_data)
+{
+	struct adi_fft_iio_desc *desc;
+	uint32_t cnt;
+	int32_t value;
+	float db;
+	int ret;
+
+	if (!iio_dev_data || !iio_dev_data->dev || !iio_dev_data->buffer)
+		return -EINVAL;
+
+	desc = iio_dev_data->dev;
+
+	for (cnt = 0; cnt < iio_dev_data->buffer->samples; cnt++) {
+		if (!desc->bin) {
+			ret = adi_fft_snapshot_read(desc->snapshot, &desc->data);
+			if (ret)
+				return ret;
+
+			if (!desc->data.num_bins)
+				return -EINVAL;
+		}
+
+		/* Empty bins are -infinity dB */
+		db = desc->data.spectrum[desc->bin];
+		if (!(db > ADI_FFT_IIO_MIN_DB))
+			db = ADI_FFT_IIO_MIN_DB;
+		value = lroundf(db / ADI_FFT_IIO_MAGNITUDE_SCALE);
+
+		ret = iio_buffer_push_scan(iio_dev_data->buffer, &value);
+		if (ret)
+			return ret;
+
+		if (++desc->bin == desc->data.num_bins)
+			desc->bin = 0;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Initialize the FFT IIO device
+ * @param desc[out] - FFT IIO device descriptor
+ * @param param[in] - FFT IIO device init parameters
+ * @return 0 in case of success, negative error code otherwise
+ * @note The descriptor is the device instance to be registered with the IIO
+ *	 application, along with desc->iio_dev.
+ */
+int adi_fft_iio_init(struct adi_fft_iio_desc **desc,
+		     const struct adi_fft_iio_init_param *param)
+{
+	struct adi_fft_iio_desc *fft_iio;
+
+	if (!desc || !param || !param->snapshot)
+		return -EINVAL;
+
+	fft_iio = calloc(1, sizeof(*fft_iio));
+	if (!fft_iio)
+		return -ENOMEM;
+
+	fft_iio->snapshot = param->snapshot;
+	fft_iio->iio_dev = &adi_fft_iio_device;
+
+	*desc = fft_iio;
+
+	return 0;
+}
+
+/**
+ * @brief Free the resources allocated by adi_fft_iio_init()
+ * @param desc[in] - FFT IIO device descriptor
+ * @return 0 in case of success, negative error code otherwise
+ */
+int adi_fft_iio_remove(struct adi_fft_iio_desc *desc)
+{
+	if (!desc)
+		return -EINVAL;
+
+	free(desc);
+
+	return 0;
+}
@@ -0,0 +1,63 @@
+/*************************************************************************//**
+ *   @file   adi_fft_iio.h
+ *   @brief  FFT results IIO device headers
+******************************************************************************
+* Copyright (c) 2024 Analog Devices, Inc.
+* All rights reserved.
+*
+* This software is proprietary to Analog Devices, Inc. and its licensors.
+* By using this software you agree to the terms of the associated
+* Analog Devices Software License Agreement.
+*****************************************************************************/
+
+#ifndef _ADI_FFT_IIO_H_
+#define _ADI_FFT_IIO_H_
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "iio.h"
+#include "adi_fft_snapshot.h"
+
+/******************************************************************************/
+/************************ Macros/Constants ************************************/
+/******************************************************************************/
+
+/* Scale of the magnitude channel, dB per LSB */
+#define ADI_FFT_IIO_MAGNITUDE_SCALE	0.001
+
+/* Lowest magnitude streamed, dB */
+#if !defined(ADI_FFT_IIO_MIN_DB)
+#define ADI_FFT_IIO_MIN_DB		-200
+#endif
+
+/******************************************************************************/
+/************************ Public Declarations *********************************/
+/******************************************************************************/
+
+/* FFT IIO device init parameters */
+struct adi_fft_iio_init_param {
+	/* Snapshot the FFT results are published to */
+	struct adi_fft_snapshot *snapshot;
+};
+
+/* FFT IIO device descriptor */
+struct adi_fft_iio_desc {
+	/* Snapshot the FFT results are read from */
+	struct adi_fft_snapshot *snapshot;
+	/* IIO device, to be registered with the IIO application */
+	struct iio_device *iio_dev;
+	/* FFT results being exported */
+	struct adi_fft_snapshot_data data;
+	/* Next bin of the spectrum to be streamed, 0 to start a new spectrum */
+	uint16_t bin;
+};
+
+int adi_fft_iio_init(struct adi_fft_iio_desc **desc,
+		     const struct adi_fft_iio_init_param *param);
+int adi_fft_iio_remove(struct adi_fft_iio_desc *desc);
+
+#endif	// !_ADI_FFT_IIO_H_
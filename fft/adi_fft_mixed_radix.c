@@ -0,0 +1,375 @@
+/***************************************************************************//**
+ *   @file    adi_fft_mixed_radix.c
+ *   @brief   Mixed radix and Bluestein FFT implementation
+ *   @details Complex forward FFT for the lengths which are not supported by
+ *	      the CMSIS-DSP CFFT. The length is split in radix 2, 3 and 5
+ *	      stages (decimation in time). Lengths with any other prime factor
+ *	      are computed as a convolution (Bluestein algorithm), through a
+ *	      power of 2 CMSIS-DSP CFFT.
+********************************************************************************
+ * Copyright (c) 2024 Analog Devices, Inc.
+ *
+ * This software is proprietary to Analog Devices, Inc. and its licensors.
+ * By using this software you agree to the terms of the associated
+ * Analog Devices Software License Agreement.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+#include "adi_fft_mixed_radix.h"
+
+/******************************************************************************/
+/******************** Variables and User Defined Data Types *******************/
+/******************************************************************************/
+
+/* Supported radixes, the largest stages being computed first */
+static const uint8_t adi_fft_mr_radixes[] = { 5, 3, 2 };
+
+/* Largest supported radix */
+#define ADI_FFT_MR_MAX_RADIX		5
+
+/* Largest power of 2 CFFT length supported by CMSIS-DSP */
+#define ADI_FFT_MR_MAX_CONV_LENGTH	4096
+
+/* Smallest power of 2 CFFT length supported by CMSIS-DSP */
+#define ADI_FFT_MR_MIN_CONV_LENGTH	16
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Split the FFT length in radix stages
+ * @param desc[in,out] - FFT plan
+ * @return true if the length is made of supported radixes only
+ */
+static bool adi_fft_mr_factorize(struct adi_fft_mixed_radix *desc)
+{
+	uint16_t remaining = desc->length;
+	uint8_t cnt;
+
+	desc->num_factors = 0;
+
+	for (cnt = 0; cnt < sizeof(adi_fft_mr_radixes); cnt++) {
+		while (!(remaining % adi_fft_mr_radixes[cnt])) {
+			if (desc->num_factors >= ADI_FFT_MR_MAX_FACTORS)
+				return false;
+
+			remaining /= adi_fft_mr_radixes[cnt];
+			desc->factors[desc->num_factors] = adi_fft_mr_radixes[cnt];
+			desc->spans[desc->num_factors] = remaining;
+			desc->num_factors++;
+		}
+	}
+
+	return remaining == 1;
+}
+
+/**
+ * @brief Radix 2 butterflies of a stage
+ * @param desc[in] - FFT plan
+ * @param out[in,out] - Stage data, 2 sub-FFTs of span length
+ * @param fstride[in] - Twiddles stride of the stage
+ * @param span[in] - Length of the sub-FFTs
+ * @return none
+ */
+static void adi_fft_mr_butterfly_2(const struct adi_fft_mixed_radix *desc,
+				   float *out, uint32_t fstride, uint16_t span)
+{
+	float *a = out;
+	float *b = out + 2 * span;
+	const float *tw;
+	float re, im;
+	uint16_t u;
+
+	for (u = 0; u < span; u++) {
+		tw = &desc->twiddles[2 * u * fstride];
+		re = b[2 * u] * tw[0] - b[2 * u + 1] * tw[1];
+		im = b[2 * u] * tw[1] + b[2 * u + 1] * tw[0];
+
+		b[2 * u] = a[2 * u] - re;
+		b[2 * u + 1] = a[2 * u + 1] - im;
+		a[2 * u] += re;
+		a[2 * u + 1] += im;
+	}
+}
+
+/**
+ * @brief Radix 3 and 5 butterflies of a stage
+ * @param desc[in] - FFT plan
+ * @param out[in,out] - Stage data, radix sub-FFTs of span length
+ * @param fstride[in] - Twiddles stride of the stage
+ * @param radix[in] - Radix of the stage
+ * @param span[in] - Length of the sub-FFTs
+ * @return none
+ */
+static void adi_fft_mr_butterfly(const struct adi_fft_mixed_radix *desc,
+				 float *out, uint32_t fstride, uint8_t radix,
+				 uint16_t span)
+{
+	float x[2 * ADI_FFT_MR_MAX_RADIX];
+	const float *tw;
+	float re, im;
+	uint16_t u;
+	uint8_t q, k;
+
+	for (u = 0; u < span; u++) {
+		/* Twiddled inputs of the butterfly */
+		x[0] = out[2 * u];
+		x[1] = out[2 * u + 1];
+		for (q = 1; q < radix; q++) {
+			tw = &desc->twiddles[2 * q * u * fstride];
+			re = out[2 * (u + q * span)];
+			im = out[2 * (u + q * span) + 1];
+			x[2 * q] = re * tw[0] - im * tw[1];
+			x[2 * q + 1] = re * tw[1] + im * tw[0];
+		}
+
+		/* Radix point DFT, the twiddles of the full length being reused
+		 * with a stride of length / radix */
+		for (k = 0; k < radix; k++) {
+			re = x[0];
+			im = x[1];
+			for (q = 1; q < radix; q++) {
+				tw = &desc->twiddles[2 * ((q * k) % radix) * span * fstride];
+				re += x[2 * q] * tw[0] - x[2 * q + 1] * tw[1];
+				im += x[2 * q] * tw[1] + x[2 * q + 1] * tw[0];
+			}
+			out[2 * (u + k * span)] = re;
+			out[2 * (u + k * span) + 1] = im;
+		}
+	}
+}
+
+/**
+ * @brief Compute one radix stage and, recursively, the stages below it
+ * @param desc[in] - FFT plan
+ * @param out[out] - Stage output
+ * @param in[in] - FFT input
+ * @param fstride[in] - Input (and twiddles) stride of the stage
+ * @param stage[in] - Stage index
+ * @return none
+ */
+static void adi_fft_mr_stage(const struct adi_fft_mixed_radix *desc,
+			     float *out, const float *in, uint32_t fstride,
+			     uint8_t stage)
+{
+	const uint8_t radix = desc->factors[stage];
+	const uint16_t span = desc->spans[stage];
+	uint8_t q;
+
+	if (span == 1) {
+		/* Last stage, gather the decimated inputs */
+		for (q = 0; q < radix; q++) {
+			out[2 * q] = in[2 * q * fstride];
+			out[2 * q + 1] = in[2 * q * fstride + 1];
+		}
+	} else {
+		for (q = 0; q < radix; q++)
+			adi_fft_mr_stage(desc, out + 2 * q * span, in + 2 * q * fstride,
+					 fstride * radix, stage + 1);
+	}
+
+	if (radix == 2)
+		adi_fft_mr_butterfly_2(desc, out, fstride, span);
+	else
+		adi_fft_mr_butterfly(desc, out, fstride, radix, span);
+}
+
+/**
+ * @brief Prepare the Bluestein chirp and convolution kernel
+ * @param desc[in,out] - FFT plan
+ * @return 0 in case of success, negative error code otherwise
+ */
+static int adi_fft_mr_bluestein_init(struct adi_fft_mixed_radix *desc)
+{
+	uint32_t conv_length = ADI_FFT_MR_MIN_CONV_LENGTH;
+	uint32_t n;
+	double angle;
+
+	/* Linear (not circular) convolution of length * 2 - 1 samples */
+	while (conv_length < 2 * (uint32_t)desc->length - 1)
+		conv_length *= 2;
+	if (conv_length > ADI_FFT_MR_MAX_CONV_LENGTH)
+		return -EINVAL;
+	desc->conv_length = conv_length;
+
+	if (arm_cfft_init_f32(&desc->cfft_instance, desc->conv_length))
+		return -EINVAL;
+
+	desc->chirp = calloc(2 * desc->length, sizeof(float));
+	desc->kernel_fft = calloc(2 * desc->conv_length, sizeof(float));
+	desc->work = calloc(2 * desc->conv_length, sizeof(float));
+	if (!desc->chirp || !desc->kernel_fft || !desc->work)
+		return -ENOMEM;
+
+	for (n = 0; n < desc->length; n++) {
+		/* n^2 taken modulo 2 * length to keep the angle accurate */
+		angle = -PI * (double)((n * n) % (2 * (uint32_t)desc->length)) /
+			desc->length;
+		desc->chirp[2 * n] = cos(angle);
+		desc->chirp[2 * n + 1] = sin(angle);
+
+		/* Kernel = conjugated chirp, symmetric around 0 */
+		desc->kernel_fft[2 * n] = desc->chirp[2 * n];
+		desc->kernel_fft[2 * n + 1] = -desc->chirp[2 * n + 1];
+		if (n) {
+			desc->kernel_fft[2 * (conv_length - n)] = desc->chirp[2 * n];
+			desc->kernel_fft[2 * (conv_length - n) + 1] = -desc->chirp[2 * n + 1];
+		}
+	}
+
+	arm_cfft_f32(&desc->cfft_instance, desc->kernel_fft, 0, 1);
+
+	return 0;
+}
+
+/**
+ * @brief Compute the FFT with the Bluestein algorithm
+ * @param desc[in] - FFT plan
+ * @param data[in,out] - Complex interleaved data
+ * @return none
+ */
+static void adi_fft_mr_bluestein(struct adi_fft_mixed_radix *desc,
+				 float *data)
+{
+	const float *w;
+	float *x;
+	float re, im;
+	uint16_t n;
+
+	/* Input multiplied by the chirp, zero padded */
+	for (n = 0; n < desc->length; n++) {
+		w = &desc->chirp[2 * n];
+		x = &data[2 * n];
+		desc->work[2 * n] = x[0] * w[0] - x[1] * w[1];
+		desc->work[2 * n + 1] = x[0] * w[1] + x[1] * w[0];
+	}
+	memset(&desc->work[2 * desc->length], 0,
+	       2 * (desc->conv_length - desc->length) * sizeof(float));
+
+	/* Convolution with the kernel */
+	arm_cfft_f32(&desc->cfft_instance, desc->work, 0, 1);
+	for (n = 0; n < desc->conv_length; n++) {
+		w = &desc->kernel_fft[2 * n];
+		x = &desc->work[2 * n];
+		re = x[0] * w[0] - x[1] * w[1];
+		im = x[0] * w[1] + x[1] * w[0];
+		x[0] = re;
+		x[1] = im;
+	}
+	arm_cfft_f32(&desc->cfft_instance, desc->work, 1, 1);
+
+	/* Output multiplied by the chirp */
+	for (n = 0; n < desc->length; n++) {
+		w = &desc->chirp[2 * n];
+		x = &desc->work[2 * n];
+		data[2 * n] = x[0] * w[0] - x[1] * w[1];
+		data[2 * n + 1] = x[0] * w[1] + x[1] * w[0];
+	}
+}
+
+/**
+ * @brief Initialize the FFT plan of a given length
+ * @param desc[out] - FFT plan
+ * @param length[in] - FFT length
+ * @return 0 in case of success, negative error code otherwise
+ * @note The twiddles (mixed radix) or the chirp and the convolution kernel
+ *	 (Bluestein) are computed once here, plans should be kept for as long
+ *	 as the FFT length doesn't change.
+ */
+int adi_fft_mixed_radix_init(struct adi_fft_mixed_radix **desc,
+			     uint16_t length)
+{
+	struct adi_fft_mixed_radix *plan;
+	double angle;
+	uint16_t cnt;
+	int ret;
+
+	if (!desc || length < 2)
+		return -EINVAL;
+
+	plan = calloc(1, sizeof(*plan));
+	if (!plan)
+		return -ENOMEM;
+
+	plan->length = length;
+	plan->bluestein = !adi_fft_mr_factorize(plan);
+
+	if (plan->bluestein) {
+		ret = adi_fft_mr_bluestein_init(plan);
+		if (ret)
+			goto error;
+	} else {
+		plan->twiddles = calloc(2 * length, sizeof(float));
+		plan->scratch = calloc(2 * length, sizeof(float));
+		if (!plan->twiddles || !plan->scratch) {
+			ret = -ENOMEM;
+			goto error;
+		}
+
+		for (cnt = 0; cnt < length; cnt++) {
+			angle = -2.0 * PI * cnt / length;
+			plan->twiddles[2 * cnt] = cos(angle);
+			plan->twiddles[2 * cnt + 1] = sin(angle);
+		}
+	}
+
+	*desc = plan;
+
+	return 0;
+
+error:
+	adi_fft_mixed_radix_remove(plan);
+
+	return ret;
+}
+
+/**
+ * @brief Free the resources allocated by adi_fft_mixed_radix_init()
+ * @param desc[in] - FFT plan
+ * @return 0 in case of success, negative error code otherwise
+ */
+int adi_fft_mixed_radix_remove(struct adi_fft_mixed_radix *desc)
+{
+	if (!desc)
+		return -EINVAL;
+
+	free(desc->twiddles);
+	free(desc->scratch);
+	free(desc->chirp);
+	free(desc->kernel_fft);
+	free(desc->work);
+	free(desc);
+
+	return 0;
+}
+
+/**
+ * @brief Compute the forward complex FFT in place
+ * @param desc[in] - FFT plan
+ * @param data[in,out] - Complex interleaved data, length samples
+ * @return 0 in case of success, negative error code otherwise
+ * @note Output is in natural order and not scaled, same as the CMSIS-DSP CFFT.
+ */
+int adi_fft_mixed_radix_run(struct adi_fft_mixed_radix *desc, float *data)
+{
+	if (!desc || !data)
+		return -EINVAL;
+
+	if (desc->bluestein) {
+		adi_fft_mr_bluestein(desc, data);
+		return 0;
+	}
+
+	adi_fft_mr_stage(desc, desc->scratch, data, 1, 0);
+	memcpy(data, desc->scratch, 2 * desc->length * sizeof(float));
+
+	return 0;
+}
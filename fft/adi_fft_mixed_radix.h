@@ -0,0 +1,70 @@
+/*************************************************************************//**
+ *   @file   adi_fft_mixed_radix.h
+ *   @brief  Mixed radix and Bluestein FFT headers
+******************************************************************************
+* Copyright (c) 2024 Analog Devices, Inc.
+* All rights reserved.
+*
+* This software is proprietary to Analog Devices, Inc. and its licensors.
+* By using this software you agree to the terms of the associated
+* Analog Devices Software License Agreement.
+*****************************************************************************/
+
+#ifndef _ADI_FFT_MIXED_RADIX_H_
+#define _ADI_FFT_MIXED_RADIX_H_
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <arm_math.h>
+
+/******************************************************************************/
+/************************ Macros/Constants ************************************/
+/******************************************************************************/
+
+/* Max number of radix stages, enough for any 16-bit FFT length */
+#define ADI_FFT_MR_MAX_FACTORS		16
+
+/******************************************************************************/
+/************************ Public Declarations *********************************/
+/******************************************************************************/
+
+/* Complex FFT plan for a length which is not a power of 2.
+ * Lengths made of 2, 3 and 5 factors (e.g. 1000, 1500, 2000) are computed
+ * with mixed radix stages, any other length with the Bluestein algorithm */
+struct adi_fft_mixed_radix {
+	/* FFT length */
+	uint16_t length;
+	/* Bluestein algorithm used for this length */
+	bool bluestein;
+	/* Number of radix stages */
+	uint8_t num_factors;
+	/* Radix of each stage */
+	uint8_t factors[ADI_FFT_MR_MAX_FACTORS];
+	/* Length of the sub-FFTs below each stage */
+	uint16_t spans[ADI_FFT_MR_MAX_FACTORS];
+	/* Twiddle factors exp(-2*pi*j*k/length), complex interleaved */
+	float *twiddles;
+	/* Output of the radix stages, complex interleaved */
+	float *scratch;
+	/* Length of the Bluestein convolution FFT (power of 2) */
+	uint16_t conv_length;
+	/* Bluestein chirp exp(-pi*j*n^2/length), complex interleaved */
+	float *chirp;
+	/* FFT of the Bluestein convolution kernel, complex interleaved */
+	float *kernel_fft;
+	/* Bluestein convolution buffer, complex interleaved */
+	float *work;
+	/* Instance of the CMSIS-DSP CFFT used for the convolution */
+	arm_cfft_instance_f32 cfft_instance;
+};
+
+int adi_fft_mixed_radix_init(struct adi_fft_mixed_radix **desc,
+			     uint16_t length);
+int adi_fft_mixed_radix_remove(struct adi_fft_mixed_radix *desc);
+int adi_fft_mixed_radix_run(struct adi_fft_mixed_radix *desc, float *data);
+
+#endif	// !_ADI_FFT_MIXED_RADIX_H_
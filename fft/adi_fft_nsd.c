@@ -0,0 +1,373 @@
+/***************************************************************************//**
+ *   @file    adi_fft_nsd.c
+ *   @brief   Noise spectral density (NSD) analysis implementation
+ *   @details Streaming NSD over many decades with a constant memory usage.
+ *	      The input data is decimated by 2 from one stage to the next one
+ *	      (halfband filters). Each stage averages the PSD of 50% overlapped
+ *	      and windowed segments (Welch method) and covers one octave of
+ *	      the spectrum, the last stage covering the lowest frequencies. The
+ *	      octaves are merged into log spaced NSD points.
+********************************************************************************
+ * Copyright (c) 2024 Analog Devices, Inc.
+ *
+ * This software is proprietary to Analog Devices, Inc. and its licensors.
+ * By using this software you agree to the terms of the associated
+ * Analog Devices Software License Agreement.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+#include "adi_fft_nsd.h"
+#include "adi_fft_windowing.h"
+
+/******************************************************************************/
+/******************** Variables and User Defined Data Types *******************/
+/******************************************************************************/
+
+/* Lowest bin of the last stage, above the Blackman-Harris 7 term window main
+ * lobe that spreads the residual DC and the slow drifts into bins 1 to 6 */
+#define ADI_FFT_NSD_MIN_BIN	7
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Compute the segments window and the halfband filter
+ * @param desc[in,out] - NSD descriptor
+ * @return none
+ */
+static void adi_fft_nsd_design(struct adi_fft_nsd *desc)
+{
+	const int16_t center = (ADI_FFT_NSD_HB_TAPS - 1) / 2;
+	uint16_t cnt;
+	uint8_t iter;
+	int16_t n;
+	double term, sum = 0.0;
+
+	/* Periodic Blackman-Harris 7 term window */
+	desc->window_power = 0.0;
+	for (cnt = 0; cnt < ADI_FFT_NSD_SEGMENT_LEN; cnt++) {
+		term = 0.0;
+		for (iter = 0; iter < ADI_FFT_NUM_OF_TERMS; iter++)
+			term += adi_fft_7_term_bh_coefs[iter] * cos(2.0 * PI * iter * cnt /
+					ADI_FFT_NSD_SEGMENT_LEN);
+		desc->window[cnt] = term;
+		desc->window_power += term * term;
+	}
+
+	/* Halfband lowpass, Blackman windowed sinc with cut-off at fs / 4 */
+	for (cnt = 0; cnt < ADI_FFT_NSD_HB_TAPS; cnt++) {
+		n = cnt - center;
+		term = n ? sin(PI * n / 2.0) / (PI * n) : 0.5;
+		term *= 0.42 - 0.5 * cos(2.0 * PI * cnt / (ADI_FFT_NSD_HB_TAPS - 1)) +
+			0.08 * cos(4.0 * PI * cnt / (ADI_FFT_NSD_HB_TAPS - 1));
+		desc->halfband[cnt] = term;
+		sum += term;
+	}
+
+	/* Unity gain in the passband */
+	for (cnt = 0; cnt < ADI_FFT_NSD_HB_TAPS; cnt++)
+		desc->halfband[cnt] /= sum;
+}
+
+/**
+ * @brief Initialize the NSD analysis
+ * @param desc[out] - NSD descriptor
+ * @param param[in] - NSD init parameters
+ * @return 0 in case of success, negative error code otherwise
+ */
+int adi_fft_nsd_init(struct adi_fft_nsd **desc,
+		     const struct adi_fft_nsd_init_param *param)
+{
+	struct adi_fft_nsd *nsd;
+
+	if (!desc || !param || param->sample_rate <= 0 || !param->num_stages
+	    || param->num_stages > ADI_FFT_NSD_MAX_STAGES)
+		return -EINVAL;
+
+	nsd = calloc(1, sizeof(*nsd));
+	if (!nsd)
+		return -ENOMEM;
+
+	if (arm_cfft_init_f32(&nsd->cfft_instance, ADI_FFT_NSD_SEGMENT_LEN)) {
+		free(nsd);
+		return -EINVAL;
+	}
+
+	nsd->sample_rate = param->sample_rate;
+	nsd->num_stages = param->num_stages;
+	adi_fft_nsd_design(nsd);
+
+	*desc = nsd;
+
+	return 0;
+}
+
+/**
+ * @brief Free the resources allocated by adi_fft_nsd_init()
+ * @param desc[in] - NSD descriptor
+ * @return 0 in case of success, negative error code otherwise
+ */
+int adi_fft_nsd_remove(struct adi_fft_nsd *desc)
+{
+	if (!desc)
+		return -EINVAL;
+
+	free(desc);
+
+	return 0;
+}
+
+/**
+ * @brief Clear the averaged PSD and the decimation filters
+ * @param desc[in,out] - NSD descriptor
+ * @return none
+ */
+void adi_fft_nsd_reset(struct adi_fft_nsd *desc)
+{
+	if (!desc)
+		return;
+
+	memset(desc->stages, 0, sizeof(desc->stages));
+	desc->offset_valid = false;
+}
+
+/**
+ * @brief Add the PSD of a full segment to the stage average
+ * @param desc[in,out] - NSD descriptor
+ * @param stage[in] - Stage index
+ * @return none
+ */
+static void adi_fft_nsd_segment(struct adi_fft_nsd *desc, uint8_t stage)
+{
+	struct adi_fft_nsd_stage *st = &desc->stages[stage];
+	const float scale = 2.0 / (desc->sample_rate / (1UL << stage) *
+				   desc->window_power);
+	float re, im, mean = 0.0;
+	uint16_t cnt;
+
+	/* The halfband filters pass DC at unity gain, the input offset being
+	 * removed from each segment before windowing */
+	for (cnt = 0; cnt < ADI_FFT_NSD_SEGMENT_LEN; cnt++)
+		mean += st->segment[cnt];
+	mean /= ADI_FFT_NSD_SEGMENT_LEN;
+
+	for (cnt = 0; cnt < ADI_FFT_NSD_SEGMENT_LEN; cnt++) {
+		desc->fft_buf[2 * cnt] = (st->segment[cnt] - mean) * desc->window[cnt];
+		desc->fft_buf[2 * cnt + 1] = 0.0;
+	}
+
+	arm_cfft_f32(&desc->cfft_instance, desc->fft_buf, 0, 1);
+
+	/* Running average, stable for any number of segments */
+	st->segments++;
+	for (cnt = 0; cnt < ADI_FFT_NSD_SEGMENT_LEN / 2; cnt++) {
+		re = desc->fft_buf[2 * cnt];
+		im = desc->fft_buf[2 * cnt + 1];
+		st->psd[cnt] += ((re * re + im * im) * scale - st->psd[cnt]) / st->segments;
+	}
+
+	/* 50% overlap with the next segment */
+	memmove(st->segment, &st->segment[ADI_FFT_NSD_SEGMENT_LEN / 2],
+		ADI_FFT_NSD_SEGMENT_LEN / 2 * sizeof(float));
+	st->fill = ADI_FFT_NSD_SEGMENT_LEN / 2;
+}
+
+/**
+ * @brief Filter a sample with the stage halfband filter
+ * @param desc[in] - NSD descriptor
+ * @param st[in,out] - Decimation stage
+ * @param sample[in,out] - Input sample, output sample of the next stage
+ * @return true if a sample is output (every second input sample)
+ */
+static bool adi_fft_nsd_decimate(struct adi_fft_nsd *desc,
+				 struct adi_fft_nsd_stage *st, float *sample)
+{
+	uint8_t cnt, idx;
+	float sum = 0.0;
+
+	st->delay[st->delay_idx] = *sample;
+	idx = st->delay_idx;
+	st->delay_idx = (st->delay_idx + 1) % ADI_FFT_NSD_HB_TAPS;
+
+	st->odd = !st->odd;
+	if (st->odd)
+		return false;
+
+	for (cnt = 0; cnt < ADI_FFT_NSD_HB_TAPS; cnt++) {
+		sum += desc->halfband[cnt] * st->delay[idx];
+		idx = idx ? idx - 1 : ADI_FFT_NSD_HB_TAPS - 1;
+	}
+	*sample = sum;
+
+	return true;
+}
+
+/**
+ * @brief Push input data through the decimation stages
+ * @param desc[in,out] - NSD descriptor
+ * @param data[in] - Input data in volts
+ * @param len[in] - Number of samples
+ * @return 0 in case of success, negative error code otherwise
+ */
+int adi_fft_nsd_push(struct adi_fft_nsd *desc, const float *data,
+		     uint32_t len)
+{
+	struct adi_fft_nsd_stage *st;
+	uint32_t cnt;
+	uint8_t stage;
+	float sample;
+
+	if (!desc || !data)
+		return -EINVAL;
+
+	/* A constant reference removed from the input keeps a large offset
+	 * from swamping the noise in the single precision decimation */
+	if (len && !desc->offset_valid) {
+		desc->offset = data[0];
+		desc->offset_valid = true;
+	}
+
+	for (cnt = 0; cnt < len; cnt++) {
+		sample = data[cnt] - desc->offset;
+
+		for (stage = 0; stage < desc->num_stages; stage++) {
+			st = &desc->stages[stage];
+
+			st->segment[st->fill++] = sample;
+			if (st->fill == ADI_FFT_NSD_SEGMENT_LEN)
+				adi_fft_nsd_segment(desc, stage);
+
+			if (stage + 1 == desc->num_stages
+			    || !adi_fft_nsd_decimate(desc, st, &sample))
+				break;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Estimate the white noise floor and the 1/f corner
+ * @param result[in,out] - Log spaced NSD
+ * @return none
+ * @note The white noise floor is the median NSD of the upper decade. The 1/f
+ *	 corner is where the NSD rises 3 dB above the white noise floor.
+ */
+static void adi_fft_nsd_corner(struct adi_fft_nsd_result *result)
+{
+	float sorted[ADI_FFT_NSD_MAX_POINTS] = { 0 };
+	const float f_top = result->freq[result->count - 1] / 10.0;
+	float threshold, tmp, ratio;
+	uint16_t cnt, n = 0, i;
+
+	/* Sorted NSD of the upper decade */
+	for (cnt = 0; cnt < result->count; cnt++) {
+		if (result->freq[cnt] < f_top)
+			continue;
+
+		tmp = result->nsd[cnt];
+		for (i = n; i && sorted[i - 1] > tmp; i--)
+			sorted[i] = sorted[i - 1];
+		sorted[i] = tmp;
+		n++;
+	}
+	result->white_noise = sorted[n / 2];
+
+	/* Highest frequency below which the NSD stays above the threshold */
+	result->corner_freq = 0.0;
+	threshold = result->white_noise * sqrtf(2.0);
+	for (cnt = result->count - 1; cnt > 0; cnt--) {
+		if (result->nsd[cnt - 1] < threshold)
+			continue;
+		if (cnt > 1 && result->nsd[cnt - 2] < threshold)
+			continue;
+
+		/* Log-log interpolation of the crossing */
+		if (result->nsd[cnt] >= threshold) {
+			result->corner_freq = result->freq[cnt];
+			break;
+		}
+		ratio = logf(result->nsd[cnt - 1] / threshold) /
+			logf(result->nsd[cnt - 1] / result->nsd[cnt]);
+		result->corner_freq = result->freq[cnt - 1] *
+				      powf(result->freq[cnt] / result->freq[cnt - 1], ratio);
+		break;
+	}
+}
+
+/**
+ * @brief Get the log spaced NSD averaged so far
+ * @param desc[in] - NSD descriptor
+ * @param result[out] - Log spaced NSD, white noise floor and 1/f corner
+ * @return 0 in case of success, negative error code otherwise
+ * @note Stage n covers the (fs / 2^n) / 8 to (fs / 2^n) / 4 octave, the first
+ *	 stage going up to fs / 2 and the last averaged stage down to a few
+ *	 bins above DC.
+ */
+int adi_fft_nsd_get(struct adi_fft_nsd *desc,
+		    struct adi_fft_nsd_result *result)
+{
+	uint16_t points[ADI_FFT_NSD_MAX_POINTS] = { 0 };
+	float bin_width, freq, f_min;
+	uint16_t first, last, cnt, out;
+	int16_t stage, last_stage;
+	int32_t point;
+
+	if (!desc || !result)
+		return -EINVAL;
+
+	/* Deepest stage with averaged segments */
+	for (last_stage = desc->num_stages - 1; last_stage >= 0; last_stage--) {
+		if (desc->stages[last_stage].segments)
+			break;
+	}
+	if (last_stage < 0)
+		return -EAGAIN;
+
+	memset(result, 0, sizeof(*result));
+	f_min = desc->sample_rate / (1UL << last_stage) * ADI_FFT_NSD_MIN_BIN /
+		ADI_FFT_NSD_SEGMENT_LEN;
+
+	/* PSD of the stages accumulated into the log spaced points */
+	for (stage = last_stage; stage >= 0; stage--) {
+		bin_width = desc->sample_rate / (1UL << stage) / ADI_FFT_NSD_SEGMENT_LEN;
+		first = (stage == last_stage) ? ADI_FFT_NSD_MIN_BIN :
+			ADI_FFT_NSD_SEGMENT_LEN / 8 + 1;
+		last = stage ? ADI_FFT_NSD_SEGMENT_LEN / 4 :
+		       ADI_FFT_NSD_SEGMENT_LEN / 2 - 1;
+
+		for (cnt = first; cnt <= last; cnt++) {
+			freq = cnt * bin_width;
+			point = (int32_t)(ADI_FFT_NSD_POINTS_PER_DECADE * log10f(freq / f_min));
+			if (point < 0 || point >= ADI_FFT_NSD_MAX_POINTS)
+				continue;
+
+			result->freq[point] += freq;
+			result->nsd[point] += desc->stages[stage].psd[cnt];
+			points[point]++;
+		}
+	}
+
+	/* Average of each point, empty points being dropped */
+	for (cnt = 0, out = 0; cnt < ADI_FFT_NSD_MAX_POINTS; cnt++) {
+		if (!points[cnt])
+			continue;
+
+		result->freq[out] = result->freq[cnt] / points[cnt];
+		result->nsd[out] = sqrtf(result->nsd[cnt] / points[cnt]);
+		out++;
+	}
+	result->count = out;
+
+	adi_fft_nsd_corner(result);
+
+	return 0;
+}
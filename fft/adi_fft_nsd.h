@@ -0,0 +1,129 @@
+/*************************************************************************//**
+ *   @file   adi_fft_nsd.h
+ *   @brief  Noise spectral density (NSD) analysis headers
+******************************************************************************
+* Copyright (c) 2024 Analog Devices, Inc.
+* All rights reserved.
+*
+* This software is proprietary to Analog Devices, Inc. and its licensors.
+* By using this software you agree to the terms of the associated
+* Analog Devices Software License Agreement.
+*****************************************************************************/
+
+#ifndef _ADI_FFT_NSD_H_
+#define _ADI_FFT_NSD_H_
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <arm_math.h>
+
+/******************************************************************************/
+/************************ Macros/Constants ************************************/
+/******************************************************************************/
+
+/* FFT length of each decimation stage (power of 2) */
+#if !defined(ADI_FFT_NSD_SEGMENT_LEN)
+#define ADI_FFT_NSD_SEGMENT_LEN		256
+#endif
+
+/* Max number of decimation by 2 stages, each of them adding an octave
+ * towards the low frequencies */
+#if !defined(ADI_FFT_NSD_MAX_STAGES)
+#define ADI_FFT_NSD_MAX_STAGES		12
+#endif
+
+/* Number of taps of the halfband decimation filters (4 * n - 1) */
+#if !defined(ADI_FFT_NSD_HB_TAPS)
+#define ADI_FFT_NSD_HB_TAPS		23
+#endif
+
+/* Number of log spaced NSD points per decade */
+#if !defined(ADI_FFT_NSD_POINTS_PER_DECADE)
+#define ADI_FFT_NSD_POINTS_PER_DECADE	10
+#endif
+
+/* Max number of log spaced NSD points */
+#define ADI_FFT_NSD_MAX_POINTS		80
+
+/******************************************************************************/
+/************************ Public Declarations *********************************/
+/******************************************************************************/
+
+/* NSD analysis init parameters */
+struct adi_fft_nsd_init_param {
+	/* Sample rate of the input data in Hz */
+	float sample_rate;
+	/* Number of decimation stages (<= ADI_FFT_NSD_MAX_STAGES) */
+	uint8_t num_stages;
+};
+
+/* Decimation stage of the NSD analysis */
+struct adi_fft_nsd_stage {
+	/* Segment being filled, 50% overlapped with the previous one */
+	float segment[ADI_FFT_NSD_SEGMENT_LEN];
+	/* Averaged PSD of the segments, V^2/Hz */
+	float psd[ADI_FFT_NSD_SEGMENT_LEN / 2];
+	/* Delay line of the halfband filter feeding the next stage */
+	float delay[ADI_FFT_NSD_HB_TAPS];
+	/* Number of averaged segments */
+	uint32_t segments;
+	/* Number of samples in the segment */
+	uint16_t fill;
+	/* Delay line write index */
+	uint8_t delay_idx;
+	/* Odd input sample, decimated */
+	bool odd;
+};
+
+/* NSD analysis descriptor */
+struct adi_fft_nsd {
+	/* Sample rate of the input data in Hz */
+	float sample_rate;
+	/* Number of decimation stages */
+	uint8_t num_stages;
+	/* Input offset reference, first sample after a reset */
+	float offset;
+	/* Offset reference taken */
+	bool offset_valid;
+	/* Decimation stages, sample rate halved from one to the next */
+	struct adi_fft_nsd_stage stages[ADI_FFT_NSD_MAX_STAGES];
+	/* Blackman-Harris 7 term window of the segments */
+	float window[ADI_FFT_NSD_SEGMENT_LEN];
+	/* Power of the window, sum of the squared coefficients */
+	float window_power;
+	/* Halfband filter coefficients */
+	float halfband[ADI_FFT_NSD_HB_TAPS];
+	/* FFT input and output, complex interleaved */
+	float fft_buf[ADI_FFT_NSD_SEGMENT_LEN * 2];
+	/* Instance of the CMSIS-DSP CFFT */
+	arm_cfft_instance_f32 cfft_instance;
+};
+
+/* Log spaced NSD */
+struct adi_fft_nsd_result {
+	/* Number of NSD points */
+	uint16_t count;
+	/* Frequency of the NSD points in Hz */
+	float freq[ADI_FFT_NSD_MAX_POINTS];
+	/* NSD in V/sqrt(Hz) */
+	float nsd[ADI_FFT_NSD_MAX_POINTS];
+	/* White noise floor in V/sqrt(Hz) */
+	float white_noise;
+	/* 1/f corner frequency in Hz, 0 if not found */
+	float corner_freq;
+};
+
+int adi_fft_nsd_init(struct adi_fft_nsd **desc,
+		     const struct adi_fft_nsd_init_param *param);
+int adi_fft_nsd_remove(struct adi_fft_nsd *desc);
+void adi_fft_nsd_reset(struct adi_fft_nsd *desc);
+int adi_fft_nsd_push(struct adi_fft_nsd *desc, const float *data,
+		     uint32_t len);
+int adi_fft_nsd_get(struct adi_fft_nsd *desc,
+		    struct adi_fft_nsd_result *result);
+
+#endif	// !_ADI_FFT_NSD_H_
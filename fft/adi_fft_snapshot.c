@@ -0,0 +1,166 @@
+/***************************************************************************//**
+ *   @file    adi_fft_snapshot.c
+ *   @brief   FFT measurements snapshot implementation
+ *   @details Publishes the results of the FFT processing to readers running
+ *	      in other tasks or cores. The writer fills the slot the readers
+ *	      are not directed to, then switches them to it by incrementing the
+ *	      sequence counter (seqlock with two slots). The writer never waits,
+ *	      a reader copies the latest slot and tries again if a new snapshot
+ *	      was published during the copy.
+********************************************************************************
+ * Copyright (c) 2024 Analog Devices, Inc.
+ *
+ * This software is proprietary to Analog Devices, Inc. and its licensors.
+ * By using this software you agree to the terms of the associated
+ * Analog Devices Software License Agreement.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "adi_fft_snapshot.h"
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Initialize the snapshot
+ * @param desc[out] - Snapshot descriptor
+ * @param param[in] - Snapshot init parameters
+ * @return 0 in case of success, negative error code otherwise
+ */
+int adi_fft_snapshot_init(struct adi_fft_snapshot **desc,
+			  const struct adi_fft_snapshot_init_param *param)
+{
+	struct adi_fft_snapshot *snapshot;
+
+	if (!desc || !param || param->num_bins > ADI_FFT_SNAPSHOT_MAX_BINS)
+		return -EINVAL;
+
+	snapshot = calloc(1, sizeof(*snapshot));
+	if (!snapshot)
+		return -ENOMEM;
+
+	snapshot->num_bins = param->num_bins ? param->num_bins :
+			     ADI_FFT_SNAPSHOT_MAX_BINS;
+	atomic_init(&snapshot->sequence, 0);
+
+	*desc = snapshot;
+
+	return 0;
+}
+
+/**
+ * @brief Free the resources allocated by adi_fft_snapshot_init()
+ * @param desc[in] - Snapshot descriptor
+ * @return 0 in case of success, negative error code otherwise
+ */
+int adi_fft_snapshot_remove(struct adi_fft_snapshot *desc)
+{
+	if (!desc)
+		return -EINVAL;
+
+	free(desc);
+
+	return 0;
+}
+
+/**
+ * @brief Publish the results of the last FFT processing
+ * @param desc[in,out] - Snapshot descriptor
+ * @param fft_proc[in] - FFT processing parameters, adi_fft_perform() done
+ * @param fft_meas[in] - FFT measurements parameters
+ * @return 0 in case of success, negative error code otherwise
+ * @note To be called by a single writer, e.g. the task running the analysis.
+ */
+int adi_fft_snapshot_publish(struct adi_fft_snapshot *desc,
+			     struct adi_fft_processing *fft_proc,
+			     const struct adi_fft_measurements *fft_meas)
+{
+	struct adi_fft_snapshot_data *data;
+	uint16_t half, bin, cnt, last;
+	unsigned int sequence;
+	float peak, value;
+
+	if (!desc || !fft_proc || !fft_meas || !fft_proc->fft_done)
+		return -EINVAL;
+
+	/* Only the writer changes the sequence */
+	sequence = atomic_load_explicit(&desc->sequence, memory_order_relaxed);
+	data = &desc->slot[(sequence + 1) & 1];
+
+	/* The slot being reused is the one of the readers still on the previous
+	 * snapshot, the sequence they check must be updated before it */
+	atomic_thread_fence(memory_order_seq_cst);
+
+	memcpy(&data->meas, fft_meas, sizeof(data->meas));
+	data->outputs = fft_proc->outputs;
+	data->sample_rate = fft_proc->sample_rate;
+	data->fft_length = fft_proc->fft_length;
+	data->bin_width = fft_proc->bin_width;
+	data->sequence = sequence + 1;
+
+	/* Spectrum decimated by keeping the peak of the merged bins, so that
+	 * narrow tones and spurs remain visible */
+	half = fft_proc->fft_length / 2;
+	data->decimation = (half + desc->num_bins - 1) / desc->num_bins;
+	data->num_bins = 0;
+	if (fft_proc->outputs & (ADI_FFT_OUT_MAGNITUDE | ADI_FFT_OUT_DB
+				 | ADI_FFT_OUT_THD | ADI_FFT_OUT_NOISE)) {
+		for (bin = 0; bin < half; bin = last) {
+			last = (half - bin > data->decimation) ? bin + data->decimation : half;
+			peak = adi_fft_get_bin_db(fft_proc, bin);
+			for (cnt = bin + 1; cnt < last; cnt++) {
+				value = adi_fft_get_bin_db(fft_proc, cnt);
+				if (value > peak)
+					peak = value;
+			}
+			data->spectrum[data->num_bins++] = peak;
+		}
+	}
+
+	/* Readers switched to the new snapshot once it is complete */
+	atomic_store_explicit(&desc->sequence, sequence + 1, memory_order_release);
+
+	return 0;
+}
+
+/**
+ * @brief Get a consistent copy of the latest snapshot
+ * @param desc[in] - Snapshot descriptor
+ * @param data[out] - Latest snapshot
+ * @return 0 in case of success, -EAGAIN if nothing is published yet, -EBUSY
+ *	   if new snapshots kept being published during the copy, negative
+ *	   error code otherwise
+ * @note Can be called by any number of readers, concurrently with
+ *	 adi_fft_snapshot_publish().
+ */
+int adi_fft_snapshot_read(struct adi_fft_snapshot *desc,
+			  struct adi_fft_snapshot_data *data)
+{
+	unsigned int sequence;
+	uint8_t retry;
+
+	if (!desc || !data)
+		return -EINVAL;
+
+	for (retry = 0; retry < ADI_FFT_SNAPSHOT_READ_RETRIES; retry++) {
+		sequence = atomic_load_explicit(&desc->sequence, memory_order_acquire);
+		if (!sequence)
+			return -EAGAIN;
+
+		memcpy(data, &desc->slot[sequence & 1], sizeof(*data));
+
+		/* The writer may only have reused the slot if it published again */
+		atomic_thread_fence(memory_order_acquire);
+		if (atomic_load_explicit(&desc->sequence, memory_order_relaxed) == sequence)
+			return 0;
+	}
+
+	return -EBUSY;
+}
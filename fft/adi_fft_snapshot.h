@@ -0,0 +1,92 @@
+/*************************************************************************//**
+ *   @file   adi_fft_snapshot.h
+ *   @brief  FFT measurements snapshot headers
+******************************************************************************
+* Copyright (c) 2024 Analog Devices, Inc.
+* All rights reserved.
+*
+* This software is proprietary to Analog Devices, Inc. and its licensors.
+* By using this software you agree to the terms of the associated
+* Analog Devices Software License Agreement.
+*****************************************************************************/
+
+#ifndef _ADI_FFT_SNAPSHOT_H_
+#define _ADI_FFT_SNAPSHOT_H_
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "adi_fft.h"
+
+/******************************************************************************/
+/************************ Macros/Constants ************************************/
+/******************************************************************************/
+
+/* Max number of bins of the published spectrum, the spectrum of the FFT
+ * being decimated down to it */
+#if !defined(ADI_FFT_SNAPSHOT_MAX_BINS)
+#define ADI_FFT_SNAPSHOT_MAX_BINS	(ADI_FFT_MAX_SAMPLES / 2)
+#endif
+
+/* Number of attempts of a reader to get a consistent snapshot */
+#if !defined(ADI_FFT_SNAPSHOT_READ_RETRIES)
+#define ADI_FFT_SNAPSHOT_READ_RETRIES	8
+#endif
+
+/******************************************************************************/
+/************************ Public Declarations *********************************/
+/******************************************************************************/
+
+/* Results of an FFT processing, as published to the readers */
+struct adi_fft_snapshot_data {
+	/* FFT measurements */
+	struct adi_fft_measurements meas;
+	/* Outputs computed by the FFT processing (ADI_FFT_OUT_x) */
+	uint8_t outputs;
+	/* Sample rate */
+	uint32_t sample_rate;
+	/* FFT length */
+	uint16_t fft_length;
+	/* FFT bin width */
+	float bin_width;
+	/* Number of FFT bins merged into a bin of the published spectrum */
+	uint16_t decimation;
+	/* Number of bins of the published spectrum, 0 without magnitude */
+	uint16_t num_bins;
+	/* Spectrum in dB, peak of the FFT bins merged into each bin */
+	float spectrum[ADI_FFT_SNAPSHOT_MAX_BINS];
+	/* Number of the publication, from 1 */
+	uint32_t sequence;
+};
+
+/* Snapshot init parameters */
+struct adi_fft_snapshot_init_param {
+	/* Max number of bins of the published spectrum
+	 * (<= ADI_FFT_SNAPSHOT_MAX_BINS, 0 = ADI_FFT_SNAPSHOT_MAX_BINS) */
+	uint16_t num_bins;
+};
+
+/* Snapshot descriptor, single writer and any number of readers */
+struct adi_fft_snapshot {
+	/* Max number of bins of the published spectrum */
+	uint16_t num_bins;
+	/* Sequence counter, the latest snapshot being in slot sequence % 2 */
+	atomic_uint sequence;
+	/* Latest snapshot and snapshot being written */
+	struct adi_fft_snapshot_data slot[2];
+};
+
+int adi_fft_snapshot_init(struct adi_fft_snapshot **desc,
+			  const struct adi_fft_snapshot_init_param *param);
+int adi_fft_snapshot_remove(struct adi_fft_snapshot *desc);
+int adi_fft_snapshot_publish(struct adi_fft_snapshot *desc,
+			     struct adi_fft_processing *fft_proc,
+			     const struct adi_fft_measurements *fft_meas);
+int adi_fft_snapshot_read(struct adi_fft_snapshot *desc,
+			  struct adi_fft_snapshot_data *data);
+
+#endif	// !_ADI_FFT_SNAPSHOT_H_
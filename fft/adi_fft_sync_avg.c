@@ -0,0 +1,293 @@
+/***************************************************************************//**
+ *   @file    adi_fft_sync_avg.c
+ *   @brief   Time domain synchronous averaging implementation
+ *   @details Averages successive records of a coherently sampled periodic
+ *	      signal before the FFT analysis, lowering the noise floor by
+ *	      10*log10(records) dB with a single FFT. Records are summed into a
+ *	      64-bit accumulator, after a circular shift aligning them on a
+ *	      trigger edge or on the phase of the fundamental. As the records
+ *	      hold an integer number of signal periods, the circular shift
+ *	      keeps the waveform continuous. The FFT is given the fractional
+ *	      part of the averaged codes as well, so that the noise floor keeps
+ *	      going down below the quantization noise of a single code.
+********************************************************************************
+ * Copyright (c) 2024 Analog Devices, Inc.
+ *
+ * This software is proprietary to Analog Devices, Inc. and its licensors.
+ * By using this software you agree to the terms of the associated
+ * Analog Devices Software License Agreement.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+#include "adi_fft_sync_avg.h"
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Initialize the synchronous averaging
+ * @param desc[out] - Synchronous averaging descriptor
+ * @param param[in] - Synchronous averaging init parameters
+ * @return 0 in case of success, negative error code otherwise
+ */
+int adi_fft_sync_avg_init(struct adi_fft_sync_avg **desc,
+			  const struct adi_fft_sync_avg_init_param *param)
+{
+	struct adi_fft_sync_avg *avg;
+
+	if (!desc || !param || !param->length
+	    || param->length > ADI_FFT_MAX_SAMPLES)
+		return -EINVAL;
+
+	if (param->align == ADI_FFT_SYNC_ALIGN_PHASE
+	    && (!param->cycles || param->cycles >= param->length / 2))
+		return -EINVAL;
+
+	if (param->align == ADI_FFT_SYNC_ALIGN_TRIGGER
+	    && param->trigger_hysteresis < 0)
+		return -EINVAL;
+
+	avg = calloc(1, sizeof(*avg));
+	if (!avg)
+		return -ENOMEM;
+
+	avg->acc = calloc(param->length, sizeof(*avg->acc));
+	avg->fraction = calloc(param->length, sizeof(*avg->fraction));
+	if (!avg->acc || !avg->fraction) {
+		adi_fft_sync_avg_remove(avg);
+		return -ENOMEM;
+	}
+
+	avg->length = param->length;
+	avg->align = param->align;
+	avg->trigger_level = param->trigger_level;
+	avg->trigger_hysteresis = param->trigger_hysteresis;
+	avg->cycles = param->cycles;
+
+	*desc = avg;
+
+	return 0;
+}
+
+/**
+ * @brief Free the resources allocated by adi_fft_sync_avg_init()
+ * @param desc[in] - Synchronous averaging descriptor
+ * @return 0 in case of success, negative error code otherwise
+ */
+int adi_fft_sync_avg_remove(struct adi_fft_sync_avg *desc)
+{
+	if (!desc)
+		return -EINVAL;
+
+	free(desc->acc);
+	free(desc->fraction);
+	free(desc);
+
+	return 0;
+}
+
+/**
+ * @brief Clear the averaged records
+ * @param desc[in,out] - Synchronous averaging descriptor
+ * @return none
+ */
+void adi_fft_sync_avg_reset(struct adi_fft_sync_avg *desc)
+{
+	if (!desc)
+		return;
+
+	memset(desc->acc, 0, desc->length * sizeof(*desc->acc));
+	desc->records = 0;
+	desc->dropped = 0;
+}
+
+/**
+ * @brief Find the first rising edge through the trigger level
+ * @param desc[in] - Synchronous averaging descriptor
+ * @param data[in] - Record
+ * @param shift[out] - Index of the edge
+ * @return 0 in case of success, -EAGAIN if no edge is found
+ */
+static int adi_fft_sync_avg_trigger(struct adi_fft_sync_avg *desc,
+				    const int32_t *data, uint16_t *shift)
+{
+	const int64_t arm_level = (int64_t)desc->trigger_level -
+				  desc->trigger_hysteresis;
+	bool armed = false;
+	uint16_t cnt;
+
+	for (cnt = 0; cnt < desc->length; cnt++) {
+		if (data[cnt] < arm_level)
+			armed = true;
+		else if (armed && data[cnt] >= desc->trigger_level) {
+			*shift = cnt;
+			return 0;
+		}
+	}
+
+	return -EAGAIN;
+}
+
+/**
+ * @brief Get the shift aligning the fundamental phase on the first record
+ * @param desc[in,out] - Synchronous averaging descriptor
+ * @param data[in] - Record
+ * @param shift[out] - Shift of the record in samples
+ * @return none
+ * @note The phase is computed with the Goertzel algorithm at the fundamental
+ *	 bin. The shift is rounded to the sample, the residual sub-sample
+ *	 misalignment slightly attenuating the highest harmonics.
+ */
+static void adi_fft_sync_avg_phase(struct adi_fft_sync_avg *desc,
+				   const int32_t *data, uint16_t *shift)
+{
+	const double w = 2.0 * PI * desc->cycles / desc->length;
+	const double coeff = 2.0 * cos(w);
+	double s0, s1 = 0.0, s2 = 0.0, phase, delta;
+	int32_t delay;
+	uint16_t cnt;
+
+	/* Goertzel recurrence, data relative to the first sample to keep the
+	 * accuracy with large DC codes */
+	for (cnt = 0; cnt < desc->length; cnt++) {
+		s0 = (double)(data[cnt] - data[0]) + coeff * s1 - s2;
+		s2 = s1;
+		s1 = s0;
+	}
+	phase = atan2(s1 * sin(w), s1 * cos(w) - s2);
+
+	if (!desc->records) {
+		desc->ref_phase = phase;
+		*shift = 0;
+		return;
+	}
+
+	/* Delay of the record, wrapped within a signal period */
+	delta = desc->ref_phase - phase;
+	while (delta > PI)
+		delta -= 2.0 * PI;
+	while (delta <= -PI)
+		delta += 2.0 * PI;
+	delay = lround(delta / w);
+
+	*shift = (uint16_t)((delay % desc->length + desc->length) % desc->length);
+}
+
+/**
+ * @brief Add a record to the average
+ * @param desc[in,out] - Synchronous averaging descriptor
+ * @param data[in] - Record (straight binary for ADCs), length samples
+ * @return 0 in case of success, -EAGAIN if the record is dropped because
+ *	   no trigger is found, negative error code otherwise
+ */
+int adi_fft_sync_avg_add(struct adi_fft_sync_avg *desc, const int32_t *data)
+{
+	uint16_t shift = 0;
+	uint16_t cnt, idx;
+	int ret;
+
+	if (!desc || !data)
+		return -EINVAL;
+
+	switch (desc->align) {
+	case ADI_FFT_SYNC_ALIGN_NONE:
+		break;
+
+	case ADI_FFT_SYNC_ALIGN_TRIGGER:
+		ret = adi_fft_sync_avg_trigger(desc, data, &shift);
+		if (ret) {
+			desc->dropped++;
+			return ret;
+		}
+		break;
+
+	case ADI_FFT_SYNC_ALIGN_PHASE:
+		adi_fft_sync_avg_phase(desc, data, &shift);
+		break;
+
+	default:
+		return -EINVAL;
+	}
+
+	/* Accumulate the record rotated by shift samples */
+	for (cnt = 0, idx = shift; cnt < desc->length; cnt++) {
+		desc->acc[cnt] += data[idx];
+		if (++idx == desc->length)
+			idx = 0;
+	}
+
+	desc->records++;
+
+	return 0;
+}
+
+/**
+ * @brief Get the averaged record
+ * @param desc[in] - Synchronous averaging descriptor
+ * @param data[out] - Averaged record, rounded to the code, length samples
+ * @return 0 in case of success, negative error code otherwise
+ * @note Rounding adds the quantization noise of a code (q^2 / 12) back, so
+ *	 once the averaged noise is below about 1 LSB the noise floor of this
+ *	 record stops improving. adi_fft_sync_avg_perform() keeps the
+ *	 fractional part.
+ */
+int adi_fft_sync_avg_get(struct adi_fft_sync_avg *desc, int32_t *data)
+{
+	uint16_t cnt;
+	int64_t half;
+
+	if (!desc || !data)
+		return -EINVAL;
+
+	if (!desc->records)
+		return -EAGAIN;
+
+	/* Rounded to nearest, for positive and negative sums */
+	half = desc->records / 2;
+	for (cnt = 0; cnt < desc->length; cnt++)
+		data[cnt] = (desc->acc[cnt] >= 0) ?
+			    (desc->acc[cnt] + half) / desc->records :
+			    -((-desc->acc[cnt] + half) / desc->records);
+
+	return 0;
+}
+
+/**
+ * @brief Perform the FFT of the averaged record
+ * @param desc[in] - Synchronous averaging descriptor
+ * @param fft_proc[in,out] - FFT processing parameters, the FFT length being
+ *			     the record length
+ * @param fft_meas[in,out] - FFT measurements parameters
+ * @return 0 in case of success, negative error code otherwise
+ */
+int adi_fft_sync_avg_perform(struct adi_fft_sync_avg *desc,
+			     struct adi_fft_processing *fft_proc,
+			     struct adi_fft_measurements *fft_meas)
+{
+	uint16_t cnt;
+	int ret;
+
+	if (!desc || !fft_proc || !fft_meas || fft_proc->fft_length != desc->length)
+		return -EINVAL;
+
+	ret = adi_fft_sync_avg_get(desc, fft_proc->input_data);
+	if (ret)
+		return ret;
+
+	/* Remainder of the rounded average, so that the FFT sees the exact
+	 * average and the floor keeps lowering with the records */
+	for (cnt = 0; cnt < desc->length; cnt++)
+		desc->fraction[cnt] = (double)(desc->acc[cnt] -
+					       (int64_t)fft_proc->input_data[cnt] * desc->records) /
+				      desc->records;
+
+	return adi_fft_perform_fractional(fft_proc, fft_meas, desc->fraction);
+}
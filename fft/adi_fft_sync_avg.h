@@ -0,0 +1,88 @@
+/*************************************************************************//**
+ *   @file   adi_fft_sync_avg.h
+ *   @brief  Time domain synchronous averaging headers
+******************************************************************************
+* Copyright (c) 2024 Analog Devices, Inc.
+* All rights reserved.
+*
+* This software is proprietary to Analog Devices, Inc. and its licensors.
+* By using this software you agree to the terms of the associated
+* Analog Devices Software License Agreement.
+*****************************************************************************/
+
+#ifndef _ADI_FFT_SYNC_AVG_H_
+#define _ADI_FFT_SYNC_AVG_H_
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "adi_fft.h"
+
+/******************************************************************************/
+/************************ Public Declarations *********************************/
+/******************************************************************************/
+
+/* Alignment of the records before averaging */
+enum adi_fft_sync_align {
+	/* Records are already synchronous (e.g. triggered captures) */
+	ADI_FFT_SYNC_ALIGN_NONE,
+	/* Rising edge of the signal through the trigger level */
+	ADI_FFT_SYNC_ALIGN_TRIGGER,
+	/* Phase of the fundamental, relative to the first record */
+	ADI_FFT_SYNC_ALIGN_PHASE
+};
+
+/* Synchronous averaging init parameters */
+struct adi_fft_sync_avg_init_param {
+	/* Number of samples per record (<= ADI_FFT_MAX_SAMPLES) */
+	uint16_t length;
+	/* Alignment of the records */
+	enum adi_fft_sync_align align;
+	/* Trigger level, straight binary code (ADI_FFT_SYNC_ALIGN_TRIGGER) */
+	int32_t trigger_level;
+	/* Trigger hysteresis in codes, the signal must go below the trigger
+	 * level minus the hysteresis before the edge (ADI_FFT_SYNC_ALIGN_TRIGGER) */
+	int32_t trigger_hysteresis;
+	/* Number of periods of the coherently sampled signal in a record
+	 * (ADI_FFT_SYNC_ALIGN_PHASE) */
+	uint16_t cycles;
+};
+
+/* Synchronous averaging descriptor */
+struct adi_fft_sync_avg {
+	/* Number of samples per record */
+	uint16_t length;
+	/* Alignment of the records */
+	enum adi_fft_sync_align align;
+	/* Trigger level */
+	int32_t trigger_level;
+	/* Trigger hysteresis */
+	int32_t trigger_hysteresis;
+	/* Number of signal periods in a record */
+	uint16_t cycles;
+	/* Phase of the fundamental of the first record, radians */
+	float ref_phase;
+	/* Sum of the aligned records */
+	int64_t *acc;
+	/* Fractional part of the averaged codes, handed to the FFT */
+	float *fraction;
+	/* Number of averaged records */
+	uint32_t records;
+	/* Number of records dropped, no trigger found */
+	uint32_t dropped;
+};
+
+int adi_fft_sync_avg_init(struct adi_fft_sync_avg **desc,
+			  const struct adi_fft_sync_avg_init_param *param);
+int adi_fft_sync_avg_remove(struct adi_fft_sync_avg *desc);
+void adi_fft_sync_avg_reset(struct adi_fft_sync_avg *desc);
+int adi_fft_sync_avg_add(struct adi_fft_sync_avg *desc, const int32_t *data);
+int adi_fft_sync_avg_get(struct adi_fft_sync_avg *desc, int32_t *data);
+int adi_fft_sync_avg_perform(struct adi_fft_sync_avg *desc,
+			     struct adi_fft_processing *fft_proc,
+			     struct adi_fft_measurements *fft_meas);
+
+#endif	// !_ADI_FFT_SYNC_AVG_H_
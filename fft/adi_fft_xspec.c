@@ -0,0 +1,276 @@
+/***************************************************************************//**
+ *   @file    adi_fft_xspec.c
+ *   @brief   Cross-channel spectral analysis implementation
+ *   @details Compares the channels of simultaneous sampling ADCs to a
+ *	      reference channel. The complex spectrum of each channel is
+ *	      computed once per record with the window and FFT plan of the
+ *	      FFT library, and auto/cross spectra are averaged over records.
+ *	      Phase and gain mismatch, crosstalk and coherence are derived from
+ *	      the averaged spectra.
+********************************************************************************
+ * Copyright (c) 2024 Analog Devices, Inc.
+ *
+ * This software is proprietary to Analog Devices, Inc. and its licensors.
+ * By using this software you agree to the terms of the associated
+ * Analog Devices Software License Agreement.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+#include "adi_fft_xspec.h"
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Initialize the cross-channel analysis
+ * @param desc[out] - Cross-channel analysis descriptor
+ * @param param[in] - Cross-channel analysis init parameters
+ * @return 0 in case of success, negative error code otherwise
+ * @note The FFT length must not change while the descriptor is used.
+ */
+int adi_fft_xspec_init(struct adi_fft_xspec **desc,
+		       const struct adi_fft_xspec_init_param *param)
+{
+	struct adi_fft_xspec *xspec;
+	uint16_t length;
+
+	if (!desc || !param || !param->fft_proc || !param->num_channels
+	    || param->num_channels > ADI_FFT_XSPEC_MAX_CHANNELS
+	    || param->ref_channel >= param->num_channels)
+		return -EINVAL;
+
+	length = param->fft_proc->fft_length;
+	if (length < 2)
+		return -EINVAL;
+
+	xspec = calloc(1, sizeof(*xspec));
+	if (!xspec)
+		return -ENOMEM;
+
+	xspec->ref_spectrum = calloc(2 * length, sizeof(float));
+	xspec->spectrum = calloc(2 * length, sizeof(float));
+	xspec->auto_spectra = calloc(param->num_channels * (length / 2),
+				     sizeof(float));
+	xspec->cross_spectra = calloc(param->num_channels * length, sizeof(float));
+	if (!xspec->ref_spectrum || !xspec->spectrum || !xspec->auto_spectra
+	    || !xspec->cross_spectra) {
+		adi_fft_xspec_remove(xspec);
+		return -ENOMEM;
+	}
+
+	xspec->fft_proc = param->fft_proc;
+	xspec->length = length;
+	xspec->num_channels = param->num_channels;
+	xspec->ref_channel = param->ref_channel;
+
+	*desc = xspec;
+
+	return 0;
+}
+
+/**
+ * @brief Free the resources allocated by adi_fft_xspec_init()
+ * @param desc[in] - Cross-channel analysis descriptor
+ * @return 0 in case of success, negative error code otherwise
+ */
+int adi_fft_xspec_remove(struct adi_fft_xspec *desc)
+{
+	if (!desc)
+		return -EINVAL;
+
+	free(desc->ref_spectrum);
+	free(desc->spectrum);
+	free(desc->auto_spectra);
+	free(desc->cross_spectra);
+	free(desc);
+
+	return 0;
+}
+
+/**
+ * @brief Clear the averaged spectra
+ * @param desc[in,out] - Cross-channel analysis descriptor
+ * @return none
+ */
+void adi_fft_xspec_reset(struct adi_fft_xspec *desc)
+{
+	if (!desc)
+		return;
+
+	memset(desc->auto_spectra, 0,
+	       desc->num_channels * (desc->length / 2) * sizeof(float));
+	memset(desc->cross_spectra, 0,
+	       desc->num_channels * desc->length * sizeof(float));
+	desc->records = 0;
+}
+
+/**
+ * @brief Add a simultaneously sampled record of all the channels
+ * @param desc[in,out] - Cross-channel analysis descriptor
+ * @param data[in] - Input data of each channel (straight binary for ADCs),
+ *		     FFT length samples per channel
+ * @return 0 in case of success, negative error code otherwise
+ * @note One FFT is computed per channel.
+ */
+int adi_fft_xspec_push(struct adi_fft_xspec *desc, const int32_t *const *data)
+{
+	const uint16_t half = desc ? desc->length / 2 : 0;
+	const float *ref = desc ? desc->ref_spectrum : NULL;
+	float *auto_psd, *cross_psd;
+	const float *x;
+	uint16_t cnt;
+	uint8_t chn;
+	int ret;
+
+	if (!desc || !data || desc->fft_proc->fft_length != desc->length)
+		return -EINVAL;
+
+	ret = adi_fft_compute_spectrum(desc->fft_proc, data[desc->ref_channel],
+				       desc->ref_spectrum, NULL);
+	if (ret)
+		return ret;
+
+	for (chn = 0; chn < desc->num_channels; chn++) {
+		if (chn == desc->ref_channel)
+			x = desc->ref_spectrum;
+		else {
+			ret = adi_fft_compute_spectrum(desc->fft_proc, data[chn],
+						       desc->spectrum, NULL);
+			if (ret)
+				return ret;
+
+			x = desc->spectrum;
+		}
+
+		auto_psd = &desc->auto_spectra[chn * half];
+		cross_psd = &desc->cross_spectra[chn * 2 * half];
+		for (cnt = 0; cnt < half; cnt++) {
+			auto_psd[cnt] += x[2 * cnt] * x[2 * cnt] + x[2 * cnt + 1] * x[2 * cnt + 1];
+
+			/* conj(Xref) * X */
+			cross_psd[2 * cnt] += ref[2 * cnt] * x[2 * cnt] +
+					      ref[2 * cnt + 1] * x[2 * cnt + 1];
+			cross_psd[2 * cnt + 1] += ref[2 * cnt] * x[2 * cnt + 1] -
+						  ref[2 * cnt + 1] * x[2 * cnt];
+		}
+	}
+
+	desc->records++;
+
+	return 0;
+}
+
+/**
+ * @brief Compare the channels to the reference channel at its fundamental
+ * @param desc[in] - Cross-channel analysis descriptor
+ * @param result[out] - Cross-channel analysis result
+ * @return 0 in case of success, negative error code otherwise
+ * @note The power of the fundamental spread (fund_bins of the FFT processing
+ *	 parameters) is used. The coherence of a single record is always 1,
+ *	 several records must be averaged for it to be meaningful.
+ */
+int adi_fft_xspec_analyze(struct adi_fft_xspec *desc,
+			  struct adi_fft_xspec_result *result)
+{
+	const uint16_t half = desc ? desc->length / 2 : 0;
+	const float *ref_psd, *auto_psd, *cross_psd;
+	struct adi_fft_xspec_channel *channel;
+	uint16_t cnt, first, last;
+	double p_ref = 0.0, p_chn, c_re, c_im;
+	float peak = -1.0;
+	uint8_t chn;
+
+	if (!desc || !result)
+		return -EINVAL;
+
+	if (!desc->records)
+		return -EAGAIN;
+
+	/* Fundamental of the reference channel, DC bins excluded */
+	ref_psd = &desc->auto_spectra[desc->ref_channel * half];
+	result->fund_bin = 0;
+	for (cnt = desc->fft_proc->dc_bins; cnt < half; cnt++) {
+		if (ref_psd[cnt] > peak) {
+			peak = ref_psd[cnt];
+			result->fund_bin = cnt;
+		}
+	}
+	result->fund_freq = (float)desc->fft_proc->sample_rate * result->fund_bin /
+			    desc->length;
+	result->records = desc->records;
+
+	first = (result->fund_bin > desc->fft_proc->fund_bins) ?
+		result->fund_bin - desc->fft_proc->fund_bins : 0;
+	last = ((uint32_t)result->fund_bin + desc->fft_proc->fund_bins < half) ?
+	       result->fund_bin + desc->fft_proc->fund_bins : half - 1;
+
+	for (cnt = first; cnt <= last; cnt++)
+		p_ref += ref_psd[cnt];
+	if (p_ref <= 0)
+		return -EINVAL;
+
+	for (chn = 0; chn < desc->num_channels; chn++) {
+		auto_psd = &desc->auto_spectra[chn * half];
+		cross_psd = &desc->cross_spectra[chn * 2 * half];
+
+		p_chn = 0.0;
+		c_re = 0.0;
+		c_im = 0.0;
+		for (cnt = first; cnt <= last; cnt++) {
+			p_chn += auto_psd[cnt];
+			c_re += cross_psd[2 * cnt];
+			c_im += cross_psd[2 * cnt + 1];
+		}
+
+		channel = &result->channels[chn];
+
+		/* Transfer function from the reference, H = Pxy / Pxx */
+		channel->gain_mismatch = 20.0 * log10(sqrt(c_re * c_re + c_im * c_im) /
+						      p_ref);
+		channel->phase_mismatch = atan2(c_im, c_re) * 180.0 / PI;
+		channel->crosstalk = 10.0 * log10(p_chn / p_ref);
+		channel->coherence = (p_chn > 0) ?
+				     (c_re * c_re + c_im * c_im) / (p_ref * p_chn) : 0.0;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Get the magnitude squared coherence of a channel at a given bin
+ * @param desc[in] - Cross-channel analysis descriptor
+ * @param chn[in] - Channel
+ * @param bin[in] - FFT bin, first Nyquist zone
+ * @param coherence[out] - |Pxy|^2 / (Pxx * Pyy), 0 to 1
+ * @return 0 in case of success, negative error code otherwise
+ */
+int adi_fft_xspec_get_coherence(struct adi_fft_xspec *desc, uint8_t chn,
+				uint16_t bin, float *coherence)
+{
+	const uint16_t half = desc ? desc->length / 2 : 0;
+	double p_ref, p_chn, c_re, c_im;
+
+	if (!desc || !coherence || chn >= desc->num_channels || bin >= half)
+		return -EINVAL;
+
+	if (!desc->records)
+		return -EAGAIN;
+
+	p_ref = desc->auto_spectra[desc->ref_channel * half + bin];
+	p_chn = desc->auto_spectra[chn * half + bin];
+	c_re = desc->cross_spectra[(chn * half + bin) * 2];
+	c_im = desc->cross_spectra[(chn * half + bin) * 2 + 1];
+
+	*coherence = (p_ref > 0 && p_chn > 0) ?
+		     (c_re * c_re + c_im * c_im) / (p_ref * p_chn) : 0.0;
+
+	return 0;
+}
@@ -0,0 +1,104 @@
+/*************************************************************************//**
+ *   @file   adi_fft_xspec.h
+ *   @brief  Cross-channel spectral analysis headers
+******************************************************************************
+* Copyright (c) 2024 Analog Devices, Inc.
+* All rights reserved.
+*
+* This software is proprietary to Analog Devices, Inc. and its licensors.
+* By using this software you agree to the terms of the associated
+* Analog Devices Software License Agreement.
+*****************************************************************************/
+
+#ifndef _ADI_FFT_XSPEC_H_
+#define _ADI_FFT_XSPEC_H_
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdint.h>
+#include "adi_fft.h"
+
+/******************************************************************************/
+/************************ Macros/Constants ************************************/
+/******************************************************************************/
+
+/* Max number of analyzed channels */
+#if !defined(ADI_FFT_XSPEC_MAX_CHANNELS)
+#define ADI_FFT_XSPEC_MAX_CHANNELS	8
+#endif
+
+/******************************************************************************/
+/************************ Public Declarations *********************************/
+/******************************************************************************/
+
+/* Cross-channel analysis init parameters */
+struct adi_fft_xspec_init_param {
+	/* FFT processing parameters (length, window, conversion), initialized
+	 * with adi_fft_init() */
+	struct adi_fft_processing *fft_proc;
+	/* Number of channels */
+	uint8_t num_channels;
+	/* Reference channel, the other channels being compared to it */
+	uint8_t ref_channel;
+};
+
+/* Cross-channel analysis descriptor */
+struct adi_fft_xspec {
+	/* FFT processing parameters */
+	struct adi_fft_processing *fft_proc;
+	/* FFT length */
+	uint16_t length;
+	/* Number of channels */
+	uint8_t num_channels;
+	/* Reference channel */
+	uint8_t ref_channel;
+	/* Number of averaged records */
+	uint32_t records;
+	/* Complex spectrum of the reference channel, current record */
+	float *ref_spectrum;
+	/* Complex spectrum of the other channels, current record */
+	float *spectrum;
+	/* Accumulated auto spectra |X|^2 of each channel, first Nyquist zone */
+	float *auto_spectra;
+	/* Accumulated cross spectra conj(Xref) * X of each channel, complex
+	 * interleaved, first Nyquist zone */
+	float *cross_spectra;
+};
+
+/* Comparison of a channel to the reference channel */
+struct adi_fft_xspec_channel {
+	/* Gain mismatch at the fundamental, coherent part of the signal, dB */
+	float gain_mismatch;
+	/* Phase of the channel minus phase of the reference, degrees */
+	float phase_mismatch;
+	/* Power of the channel relative to the reference at the fundamental, dB */
+	float crosstalk;
+	/* Magnitude squared coherence at the fundamental (0 to 1) */
+	float coherence;
+};
+
+/* Cross-channel analysis result */
+struct adi_fft_xspec_result {
+	/* Fundamental bin of the reference channel */
+	uint16_t fund_bin;
+	/* Fundamental frequency of the reference channel in Hz */
+	float fund_freq;
+	/* Number of averaged records */
+	uint32_t records;
+	/* Comparison of each channel to the reference channel */
+	struct adi_fft_xspec_channel channels[ADI_FFT_XSPEC_MAX_CHANNELS];
+};
+
+int adi_fft_xspec_init(struct adi_fft_xspec **desc,
+		       const struct adi_fft_xspec_init_param *param);
+int adi_fft_xspec_remove(struct adi_fft_xspec *desc);
+void adi_fft_xspec_reset(struct adi_fft_xspec *desc);
+int adi_fft_xspec_push(struct adi_fft_xspec *desc, const int32_t *const *data);
+int adi_fft_xspec_analyze(struct adi_fft_xspec *desc,
+			  struct adi_fft_xspec_result *result);
+int adi_fft_xspec_get_coherence(struct adi_fft_xspec *desc, uint8_t chn,
+				uint16_t bin, float *coherence);
+
+#endif	// !_ADI_FFT_XSPEC_H_
@@ -0,0 +1,157 @@
+/***************************************************************************//**
+ *   @file    adi_fft_nsd_test.c
+ *   @brief   NSD analysis regression test
+ *   @details Host test of the white noise floor and 1/f corner estimation,
+ *	      with and without an input offset. Build and run on the host,
+ *	      CMSIS-DSP being on the include and library paths:
+ *	      gcc -I.. adi_fft_nsd_test.c ../adi_fft_nsd.c ../adi_fft_windowing.c
+ *	      -larm_math -lm && ./a.out
+********************************************************************************
+ * Copyright (c) 2024 Analog Devices, Inc.
+ *
+ * This software is proprietary to Analog Devices, Inc. and its licensors.
+ * By using this software you agree to the terms of the associated
+ * Analog Devices Software License Agreement.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdio.h>
+#include <math.h>
+#include "adi_fft_nsd.h"
+
+/******************************************************************************/
+/******************** Variables and User Defined Data Types *******************/
+/******************************************************************************/
+
+#define TEST_PI			3.14159265358979323846
+#define TEST_SAMPLE_RATE	1000.0
+#define TEST_STAGES		10
+#define TEST_BLOCK		1000
+/* Seconds of signal per test case */
+#define TEST_DURATION		2000
+/* White noise, V rms */
+#define TEST_NOISE		1e-6
+/* Accepted white noise floor error, ratio */
+#define TEST_TOLERANCE		0.05
+
+/* Seed of the noise generator */
+static uint32_t test_seed;
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Gaussian noise of unity variance (Box-Muller on a LCG)
+ * @return Noise sample
+ */
+static double test_gauss(void)
+{
+	double u, v;
+
+	test_seed = test_seed * 1664525u + 1013904223u;
+	u = (test_seed + 1.0) / 4294967297.0;
+	test_seed = test_seed * 1664525u + 1013904223u;
+	v = (test_seed + 1.0) / 4294967297.0;
+
+	return sqrt(-2.0 * log(u)) * cos(2.0 * TEST_PI * v);
+}
+
+/**
+ * @brief Measure the NSD of white noise with an optional 1/f component
+ * @param offset[in] - Input offset in V
+ * @param pink[in] - 1/f noise level relative to the white noise
+ * @param result[out] - NSD result
+ * @return 0 in case of success, negative error code otherwise
+ */
+static int test_nsd_run(double offset, double pink,
+			struct adi_fft_nsd_result *result)
+{
+	struct adi_fft_nsd_init_param param = {
+		.sample_rate = TEST_SAMPLE_RATE,
+		.num_stages = TEST_STAGES
+	};
+	/* Paul Kellet's pink noise filter */
+	double b[7] = { 0 };
+	struct adi_fft_nsd *nsd;
+	float data[TEST_BLOCK];
+	uint32_t block, cnt;
+	double w, p;
+	int ret;
+
+	ret = adi_fft_nsd_init(&nsd, &param);
+	if (ret)
+		return ret;
+
+	test_seed = 1;
+	for (block = 0; block < TEST_DURATION * TEST_SAMPLE_RATE / TEST_BLOCK;
+	     block++) {
+		for (cnt = 0; cnt < TEST_BLOCK; cnt++) {
+			w = test_gauss();
+			b[0] = 0.99886 * b[0] + w * 0.0555179;
+			b[1] = 0.99332 * b[1] + w * 0.0750759;
+			b[2] = 0.96900 * b[2] + w * 0.1538520;
+			b[3] = 0.86650 * b[3] + w * 0.3104856;
+			b[4] = 0.55000 * b[4] + w * 0.5329522;
+			b[5] = -0.7616 * b[5] - w * 0.0168980;
+			p = b[0] + b[1] + b[2] + b[3] + b[4] + b[5] + b[6] + w * 0.5362;
+			b[6] = w * 0.115926;
+
+			data[cnt] = offset + TEST_NOISE * (test_gauss() + pink * p);
+		}
+
+		ret = adi_fft_nsd_push(nsd, data, TEST_BLOCK);
+		if (ret)
+			break;
+	}
+
+	if (!ret)
+		ret = adi_fft_nsd_get(nsd, result);
+
+	adi_fft_nsd_remove(nsd);
+
+	return ret;
+}
+
+int main(void)
+{
+	static const struct {
+		double offset;
+		double pink;
+		bool corner;
+	} cases[] = {
+		/* White noise only, no 1/f corner */
+		{ 0, 0, false },
+		/* Input offset not seen as 1/f noise */
+		{ 1e-3, 0, false },
+		{ -0.5, 0, false },
+		/* 1/f noise with and without offset */
+		{ 0, 10, true },
+		{ 1e-3, 10, true },
+	};
+	const double expected = TEST_NOISE / sqrt(TEST_SAMPLE_RATE / 2.0);
+	struct adi_fft_nsd_result result;
+	unsigned int cnt, failures = 0;
+	bool pass;
+
+	for (cnt = 0; cnt < sizeof(cases) / sizeof(cases[0]); cnt++) {
+		pass = !test_nsd_run(cases[cnt].offset, cases[cnt].pink, &result)
+		       && (result.corner_freq > 0.0) == cases[cnt].corner
+		       && result.nsd[0] > 0.0;
+		/* The white noise floor is only known without 1/f noise */
+		if (!cases[cnt].pink)
+			pass = pass && fabs(result.white_noise / expected - 1.0) <=
+			       TEST_TOLERANCE;
+
+		printf("%s: offset %g V, 1/f x%g, floor %.3e V/rtHz (%.3e), lowest %.3e V/rtHz, corner %.3f Hz\n",
+		       pass ? "PASS" : "FAIL", cases[cnt].offset, cases[cnt].pink,
+		       result.white_noise, expected, result.nsd[0], result.corner_freq);
+		if (!pass)
+			failures++;
+	}
+
+	return failures ? 1 : 0;
+}
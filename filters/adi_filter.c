@@ -0,0 +1,669 @@
+/***************************************************************************//**
+ *   @file    adi_filter.c
+ *   @brief   Digital filters library implementation
+ *   @details Biquad cascade (IIR), FIR and CIC decimation filters processing
+ *            blocks of interleaved multi-channel data in place, with a state
+ *            kept per channel between the blocks.
+********************************************************************************
+ * Copyright (c) 2024 Analog Devices, Inc.
+ *
+ * This software is proprietary to Analog Devices, Inc. and its licensors.
+ * By using this software you agree to the terms of the associated
+ * Analog Devices Software License Agreement.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+#include "adi_filter.h"
+
+/******************************************************************************/
+/************************ Macros/Constants ************************************/
+/******************************************************************************/
+
+#if !defined(PI)
+#define PI	3.14159265358979323846
+#endif
+
+/* Q30 format scale, used for the FIR taps with int32 data */
+#define ADI_FILTER_Q30_SCALE	1073741824.0
+
+/* Largest float value which fits into int32 */
+#define ADI_FILTER_I32_MAX_F	2147483520.0f
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Convert a filtered value to int32, with rounding and saturation
+ * @param value[in] - Filtered value
+ * @return int32 value
+ */
+static inline int32_t adi_filter_f32_to_i32(float value)
+{
+	if (value >= ADI_FILTER_I32_MAX_F)
+		return INT32_MAX;
+	if (value <= -2147483648.0f)
+		return INT32_MIN;
+
+	return (int32_t)lrintf(value);
+}
+
+/**
+ * @brief Saturate a value to int32
+ * @param value[in] - Value to saturate
+ * @return int32 value
+ */
+static inline int32_t adi_filter_sat_i32(int64_t value)
+{
+	if (value > INT32_MAX)
+		return INT32_MAX;
+	if (value < INT32_MIN)
+		return INT32_MIN;
+
+	return (int32_t)value;
+}
+
+/**
+ * @brief Compute the coefficients of a biquad stage
+ * @param type[in] - Stage response
+ * @param fs[in] - Sample rate
+ * @param f0[in] - Cut-off (or notch) frequency
+ * @param q[in] - Quality factor (0.7071 for Butterworth response)
+ * @param coeffs[out] - Stage coefficients {b0, b1, b2, a1, a2}
+ * @return 0 in case of success, negative error code otherwise
+ */
+int adi_filter_biquad_design(enum adi_filter_biquad_type type, float fs,
+			     float f0, float q, float *coeffs)
+{
+	float w0, cos_w0, alpha, a0;
+
+	if (!coeffs || fs <= 0 || f0 <= 0 || f0 >= fs / 2 || q <= 0)
+		return -EINVAL;
+
+	w0 = 2.0 * PI * f0 / fs;
+	cos_w0 = cosf(w0);
+	alpha = sinf(w0) / (2.0 * q);
+	a0 = 1.0 + alpha;
+
+	switch (type) {
+	case ADI_FILTER_BIQUAD_LOWPASS:
+		coeffs[0] = (1.0 - cos_w0) / 2.0;
+		coeffs[1] = 1.0 - cos_w0;
+		coeffs[2] = coeffs[0];
+		break;
+
+	case ADI_FILTER_BIQUAD_HIGHPASS:
+		coeffs[0] = (1.0 + cos_w0) / 2.0;
+		coeffs[1] = -(1.0 + cos_w0);
+		coeffs[2] = coeffs[0];
+		break;
+
+	case ADI_FILTER_BIQUAD_NOTCH:
+		coeffs[0] = 1.0;
+		coeffs[1] = -2.0 * cos_w0;
+		coeffs[2] = 1.0;
+		break;
+
+	default:
+		return -EINVAL;
+	}
+
+	coeffs[3] = -2.0 * cos_w0;
+	coeffs[4] = 1.0 - alpha;
+
+	/* Normalize to a0 = 1 */
+	for (uint8_t cnt = 0; cnt < ADI_FILTER_BIQUAD_COEFFS; cnt++)
+		coeffs[cnt] /= a0;
+
+	return 0;
+}
+
+/**
+ * @brief Initialize the biquad cascade filter
+ * @param desc[out] - Filter descriptor
+ * @param param[in] - Filter init parameters
+ * @return 0 in case of success, negative error code otherwise
+ */
+int adi_filter_biquad_init(struct adi_filter_biquad **desc,
+			   const struct adi_filter_biquad_init_param *param)
+{
+	struct adi_filter_biquad *filter;
+
+	if (!desc || !param || !param->coeffs || !param->num_stages
+	    || !param->num_channels)
+		return -EINVAL;
+
+	filter = calloc(1, sizeof(*filter));
+	if (!filter)
+		return -ENOMEM;
+
+	filter->state = calloc(2 * param->num_stages * param->num_channels,
+			       sizeof(*filter->state));
+	if (!filter->state) {
+		free(filter);
+		return -ENOMEM;
+	}
+
+	filter->num_stages = param->num_stages;
+	filter->num_channels = param->num_channels;
+	filter->coeffs = param->coeffs;
+
+	*desc = filter;
+
+	return 0;
+}
+
+/**
+ * @brief Free the resources allocated by adi_filter_biquad_init()
+ * @param desc[in] - Filter descriptor
+ * @return 0 in case of success, negative error code otherwise
+ */
+int adi_filter_biquad_remove(struct adi_filter_biquad *desc)
+{
+	if (!desc)
+		return -EINVAL;
+
+	free(desc->state);
+	free(desc);
+
+	return 0;
+}
+
+/**
+ * @brief Clear the biquad cascade filter state
+ * @param desc[in] - Filter descriptor
+ * @return none
+ */
+void adi_filter_biquad_reset(struct adi_filter_biquad *desc)
+{
+	if (desc)
+		memset(desc->state, 0,
+		       2 * desc->num_stages * desc->num_channels * sizeof(*desc->state));
+}
+
+/**
+ * @brief Run one biquad stage over the samples of a channel
+ * @param coeffs[in] - Stage coefficients
+ * @param state[in,out] - Stage state of the channel
+ * @param data[in,out] - First sample of the channel
+ * @param frames[in] - Number of samples
+ * @param stride[in] - Distance between two samples of the channel
+ * @return none
+ */
+static void adi_filter_biquad_stage(const float *coeffs, float *state,
+				    float *data, uint32_t frames, uint8_t stride)
+{
+	const float b0 = coeffs[0];
+	const float b1 = coeffs[1];
+	const float b2 = coeffs[2];
+	const float a1 = coeffs[3];
+	const float a2 = coeffs[4];
+	float s1 = state[0];
+	float s2 = state[1];
+	float x, y;
+
+	/* Direct form II transposed */
+	while (frames--) {
+		x = *data;
+		y = b0 * x + s1;
+		s1 = b1 * x - a1 * y + s2;
+		s2 = b2 * x - a2 * y;
+		*data = y;
+		data += stride;
+	}
+
+	state[0] = s1;
+	state[1] = s2;
+}
+
+/**
+ * @brief Filter a block of float data with the biquad cascade
+ * @param desc[in] - Filter descriptor
+ * @param data[in,out] - Interleaved data, filtered in place
+ * @param frames[in] - Number of samples of each channel
+ * @return 0 in case of success, negative error code otherwise
+ */
+int adi_filter_biquad_process_f32(struct adi_filter_biquad *desc,
+				  float *data, uint32_t frames)
+{
+	uint8_t chn, stage;
+
+	if (!desc || !data)
+		return -EINVAL;
+
+	/* Each stage runs over the complete block, keeping its state in registers */
+	for (chn = 0; chn < desc->num_channels; chn++)
+		for (stage = 0; stage < desc->num_stages; stage++)
+			adi_filter_biquad_stage(&desc->coeffs[stage * ADI_FILTER_BIQUAD_COEFFS],
+						&desc->state[(chn * desc->num_stages + stage) * 2],
+						&data[chn], frames, desc->num_channels);
+
+	return 0;
+}
+
+/**
+ * @brief Filter a block of int32 data with the biquad cascade
+ * @param desc[in] - Filter descriptor
+ * @param data[in,out] - Interleaved data, filtered in place
+ * @param frames[in] - Number of samples of each channel
+ * @return 0 in case of success, negative error code otherwise
+ * @note Samples are converted to float by chunks of ADI_FILTER_BLOCK_LEN,
+ *	 filtered output is rounded and saturated back to int32.
+ */
+int adi_filter_biquad_process_i32(struct adi_filter_biquad *desc,
+				  int32_t *data, uint32_t frames)
+{
+	float block[ADI_FILTER_BLOCK_LEN];
+	uint32_t offset, len, cnt;
+	uint8_t chn, stage;
+
+	if (!desc || !data)
+		return -EINVAL;
+
+	for (chn = 0; chn < desc->num_channels; chn++) {
+		for (offset = 0; offset < frames; offset += len) {
+			len = frames - offset;
+			if (len > ADI_FILTER_BLOCK_LEN)
+				len = ADI_FILTER_BLOCK_LEN;
+
+			for (cnt = 0; cnt < len; cnt++)
+				block[cnt] = data[(offset + cnt) * desc->num_channels + chn];
+
+			for (stage = 0; stage < desc->num_stages; stage++)
+				adi_filter_biquad_stage(&desc->coeffs[stage * ADI_FILTER_BIQUAD_COEFFS],
+							&desc->state[(chn * desc->num_stages + stage) * 2],
+							block, len, 1);
+
+			for (cnt = 0; cnt < len; cnt++)
+				data[(offset + cnt) * desc->num_channels + chn] =
+					adi_filter_f32_to_i32(block[cnt]);
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Filter a block of int32 data with the biquad cascade
+ * @param data[in,out] - Interleaved data, filtered in place
+ * @param len[in] - Number of samples (of all channels)
+ * @param desc[in] - Filter descriptor
+ * @return 0 in case of success, negative error code otherwise
+ * @note Matches the input filter callback of the FFT library.
+ */
+int adi_filter_biquad_cb(int32_t *data, uint16_t len, void *desc)
+{
+	struct adi_filter_biquad *filter = desc;
+
+	if (!filter)
+		return -EINVAL;
+
+	return adi_filter_biquad_process_i32(filter, data, len / filter->num_channels);
+}
+
+/**
+ * @brief Initialize the FIR filter
+ * @param desc[out] - Filter descriptor
+ * @param param[in] - Filter init parameters
+ * @return 0 in case of success, negative error code otherwise
+ */
+int adi_filter_fir_init(struct adi_filter_fir **desc,
+			const struct adi_filter_fir_init_param *param)
+{
+	struct adi_filter_fir *filter;
+	size_t sample_size;
+	uint16_t cnt;
+
+	if (!desc || !param || !param->coeffs || !param->num_taps
+	    || !param->num_channels || !param->decimation)
+		return -EINVAL;
+
+	switch (param->data_type) {
+	case ADI_FILTER_DATA_FLOAT:
+		sample_size = sizeof(float);
+		break;
+
+	case ADI_FILTER_DATA_INT32:
+		sample_size = sizeof(int32_t);
+		for (cnt = 0; cnt < param->num_taps; cnt++)
+			if (fabsf(param->coeffs[cnt]) >= 2.0)
+				return -EINVAL;
+		break;
+
+	default:
+		return -EINVAL;
+	}
+
+	filter = calloc(1, sizeof(*filter));
+	if (!filter)
+		return -ENOMEM;
+
+	filter->state = calloc(2 * param->num_taps * param->num_channels,
+			       sample_size);
+	if (!filter->state)
+		goto error;
+
+	if (param->data_type == ADI_FILTER_DATA_INT32) {
+		filter->coeffs_q30 = calloc(param->num_taps, sizeof(int32_t));
+		if (!filter->coeffs_q30)
+			goto error;
+
+		for (cnt = 0; cnt < param->num_taps; cnt++)
+			filter->coeffs_q30[cnt] = (int32_t)lrint(param->coeffs[cnt] *
+						  ADI_FILTER_Q30_SCALE);
+	}
+
+	filter->num_taps = param->num_taps;
+	filter->num_channels = param->num_channels;
+	filter->decimation = param->decimation;
+	filter->data_type = param->data_type;
+	filter->coeffs = param->coeffs;
+
+	*desc = filter;
+
+	return 0;
+
+error:
+	free(filter->state);
+	free(filter);
+	return -ENOMEM;
+}
+
+/**
+ * @brief Free the resources allocated by adi_filter_fir_init()
+ * @param desc[in] - Filter descriptor
+ * @return 0 in case of success, negative error code otherwise
+ */
+int adi_filter_fir_remove(struct adi_filter_fir *desc)
+{
+	if (!desc)
+		return -EINVAL;
+
+	free(desc->coeffs_q30);
+	free(desc->state);
+	free(desc);
+
+	return 0;
+}
+
+/**
+ * @brief Clear the FIR filter delay lines
+ * @param desc[in] - Filter descriptor
+ * @return none
+ */
+void adi_filter_fir_reset(struct adi_filter_fir *desc)
+{
+	if (!desc)
+		return;
+
+	/* Float and int32 zero are both all bits clear */
+	memset(desc->state, 0, 2 * desc->num_taps * desc->num_channels *
+	       sizeof(int32_t));
+	desc->pos = 0;
+	desc->phase = 0;
+}
+
+/**
+ * @brief Filter (and decimate) a block of float data with the FIR filter
+ * @param desc[in] - Filter descriptor
+ * @param data[in,out] - Interleaved data, filtered in place
+ * @param frames[in] - Number of input samples of each channel
+ * @return number of output samples of each channel, negative error code
+ *	   otherwise
+ */
+int32_t adi_filter_fir_process_f32(struct adi_filter_fir *desc,
+				   float *data, uint32_t frames)
+{
+	const uint16_t taps = desc ? desc->num_taps : 0;
+	float *lines;
+	float *line;
+	float acc;
+	uint32_t in, out = 0;
+	uint16_t cnt;
+	uint8_t chn;
+
+	if (!desc || !data || desc->data_type != ADI_FILTER_DATA_FLOAT)
+		return -EINVAL;
+
+	lines = desc->state;
+
+	for (in = 0; in < frames; in++) {
+		/* Newest sample goes before the previous one */
+		desc->pos = (desc->pos ? desc->pos : taps) - 1;
+
+		for (chn = 0; chn < desc->num_channels; chn++) {
+			line = &lines[chn * 2 * taps];
+			line[desc->pos] = data[in * desc->num_channels + chn];
+			line[desc->pos + taps] = line[desc->pos];
+		}
+
+		if (++desc->phase < desc->decimation)
+			continue;
+		desc->phase = 0;
+
+		/* Output never overtakes the input, so data can be overwritten */
+		for (chn = 0; chn < desc->num_channels; chn++) {
+			line = &lines[chn * 2 * taps + desc->pos];
+			acc = 0.0;
+			for (cnt = 0; cnt < taps; cnt++)
+				acc += desc->coeffs[cnt] * line[cnt];
+			data[out * desc->num_channels + chn] = acc;
+		}
+		out++;
+	}
+
+	return out;
+}
+
+/**
+ * @brief Filter (and decimate) a block of int32 data with the FIR filter
+ * @param desc[in] - Filter descriptor
+ * @param data[in,out] - Interleaved data, filtered in place
+ * @param frames[in] - Number of input samples of each channel
+ * @return number of output samples of each channel, negative error code
+ *	   otherwise
+ * @note Taps are applied in Q30 format with a 64-bit accumulator.
+ */
+int32_t adi_filter_fir_process_i32(struct adi_filter_fir *desc,
+				   int32_t *data, uint32_t frames)
+{
+	const uint16_t taps = desc ? desc->num_taps : 0;
+	int32_t *lines;
+	int32_t *line;
+	int64_t acc;
+	uint32_t in, out = 0;
+	uint16_t cnt;
+	uint8_t chn;
+
+	if (!desc || !data || desc->data_type != ADI_FILTER_DATA_INT32)
+		return -EINVAL;
+
+	lines = desc->state;
+
+	for (in = 0; in < frames; in++) {
+		desc->pos = (desc->pos ? desc->pos : taps) - 1;
+
+		for (chn = 0; chn < desc->num_channels; chn++) {
+			line = &lines[chn * 2 * taps];
+			line[desc->pos] = data[in * desc->num_channels + chn];
+			line[desc->pos + taps] = line[desc->pos];
+		}
+
+		if (++desc->phase < desc->decimation)
+			continue;
+		desc->phase = 0;
+
+		for (chn = 0; chn < desc->num_channels; chn++) {
+			line = &lines[chn * 2 * taps + desc->pos];
+			acc = 0;
+			for (cnt = 0; cnt < taps; cnt++)
+				acc += (int64_t)desc->coeffs_q30[cnt] * line[cnt];
+			data[out * desc->num_channels + chn] =
+				adi_filter_sat_i32((acc + (1 << 29)) >> 30);
+		}
+		out++;
+	}
+
+	return out;
+}
+
+/**
+ * @brief Filter a block of int32 data with the FIR filter
+ * @param data[in,out] - Interleaved data, filtered in place
+ * @param len[in] - Number of samples (of all channels)
+ * @param desc[in] - Filter descriptor
+ * @return 0 in case of success, negative error code otherwise
+ * @note Matches the input filter callback of the FFT library, which needs
+ *	 the number of samples to be kept (no decimation).
+ */
+int adi_filter_fir_cb(int32_t *data, uint16_t len, void *desc)
+{
+	struct adi_filter_fir *filter = desc;
+	int32_t ret;
+
+	if (!filter || filter->decimation != 1)
+		return -EINVAL;
+
+	ret = adi_filter_fir_process_i32(filter, data, len / filter->num_channels);
+	if (ret < 0)
+		return ret;
+
+	return 0;
+}
+
+/**
+ * @brief Initialize the CIC decimation filter
+ * @param desc[out] - Filter descriptor
+ * @param param[in] - Filter init parameters
+ * @return 0 in case of success, negative error code otherwise
+ */
+int adi_filter_cic_init(struct adi_filter_cic **desc,
+			const struct adi_filter_cic_init_param *param)
+{
+	struct adi_filter_cic *filter;
+	uint64_t gain = 1;
+	uint8_t cnt;
+
+	if (!desc || !param || !param->order
+	    || param->order > ADI_FILTER_CIC_MAX_ORDER
+	    || !param->num_channels || param->decimation < 2)
+		return -EINVAL;
+
+	/* Register growth (order * log2(decimation) bits) must fit into
+	 * the 64-bit integrators along with the 32-bit input */
+	for (cnt = 0; cnt < param->order; cnt++) {
+		gain *= param->decimation;
+		if (gain > ((uint64_t)1 << 32))
+			return -EINVAL;
+	}
+
+	filter = calloc(1, sizeof(*filter));
+	if (!filter)
+		return -ENOMEM;
+
+	filter->state = calloc(2 * param->order * param->num_channels,
+			       sizeof(*filter->state));
+	if (!filter->state) {
+		free(filter);
+		return -ENOMEM;
+	}
+
+	filter->order = param->order;
+	filter->num_channels = param->num_channels;
+	filter->decimation = param->decimation;
+	filter->gain = gain;
+
+	*desc = filter;
+
+	return 0;
+}
+
+/**
+ * @brief Free the resources allocated by adi_filter_cic_init()
+ * @param desc[in] - Filter descriptor
+ * @return 0 in case of success, negative error code otherwise
+ */
+int adi_filter_cic_remove(struct adi_filter_cic *desc)
+{
+	if (!desc)
+		return -EINVAL;
+
+	free(desc->state);
+	free(desc);
+
+	return 0;
+}
+
+/**
+ * @brief Clear the CIC decimation filter state
+ * @param desc[in] - Filter descriptor
+ * @return none
+ */
+void adi_filter_cic_reset(struct adi_filter_cic *desc)
+{
+	if (!desc)
+		return;
+
+	memset(desc->state, 0,
+	       2 * desc->order * desc->num_channels * sizeof(*desc->state));
+	desc->phase = 0;
+}
+
+/**
+ * @brief Filter and decimate a block of int32 data with the CIC filter
+ * @param desc[in] - Filter descriptor
+ * @param data[in,out] - Interleaved data, filtered in place
+ * @param frames[in] - Number of input samples of each channel
+ * @return number of output samples of each channel, negative error code
+ *	   otherwise
+ * @note Integrators rely on the modulo 2^64 arithmetic, the output is
+ *	 normalized to the unity DC gain.
+ */
+int32_t adi_filter_cic_process_i32(struct adi_filter_cic *desc,
+				   int32_t *data, uint32_t frames)
+{
+	uint64_t *integ;
+	uint64_t *comb;
+	uint64_t value, prev;
+	uint32_t in, out = 0;
+	uint8_t chn, cnt;
+
+	if (!desc || !data)
+		return -EINVAL;
+
+	for (in = 0; in < frames; in++) {
+		for (chn = 0; chn < desc->num_channels; chn++) {
+			integ = &desc->state[chn * 2 * desc->order];
+			integ[0] += (uint64_t)(int64_t)data[in * desc->num_channels + chn];
+			for (cnt = 1; cnt < desc->order; cnt++)
+				integ[cnt] += integ[cnt - 1];
+		}
+
+		if (++desc->phase < desc->decimation)
+			continue;
+		desc->phase = 0;
+
+		for (chn = 0; chn < desc->num_channels; chn++) {
+			integ = &desc->state[chn * 2 * desc->order];
+			comb = &integ[desc->order];
+			value = integ[desc->order - 1];
+			for (cnt = 0; cnt < desc->order; cnt++) {
+				prev = comb[cnt];
+				comb[cnt] = value;
+				value -= prev;
+			}
+			data[out * desc->num_channels + chn] =
+				adi_filter_sat_i32((int64_t)value / (int64_t)desc->gain);
+		}
+		out++;
+	}
+
+	return out;
+}
@@ -0,0 +1,168 @@
+/*************************************************************************//**
+ *   @file   adi_filter.h
+ *   @brief  Digital filters library headers
+******************************************************************************
+* Copyright (c) 2024 Analog Devices, Inc.
+* All rights reserved.
+*
+* This software is proprietary to Analog Devices, Inc. and its licensors.
+* By using this software you agree to the terms of the associated
+* Analog Devices Software License Agreement.
+*****************************************************************************/
+
+#ifndef _ADI_FILTER_H_
+#define _ADI_FILTER_H_
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdint.h>
+
+/******************************************************************************/
+/************************ Macros/Constants ************************************/
+/******************************************************************************/
+
+/* Number of coefficients of a biquad stage: b0, b1, b2, a1, a2 */
+#define ADI_FILTER_BIQUAD_COEFFS	5
+
+/* Number of frames of int32 data converted at once for the biquad filter */
+#if !defined(ADI_FILTER_BLOCK_LEN)
+#define ADI_FILTER_BLOCK_LEN		64
+#endif
+
+/* Max order of the CIC decimator */
+#define ADI_FILTER_CIC_MAX_ORDER	6
+
+/******************************************************************************/
+/************************ Public Declarations *********************************/
+/******************************************************************************/
+
+/* Type of the filtered data samples */
+enum adi_filter_data_type {
+	ADI_FILTER_DATA_FLOAT,
+	ADI_FILTER_DATA_INT32
+};
+
+/* Biquad stage response, for the coefficients design */
+enum adi_filter_biquad_type {
+	ADI_FILTER_BIQUAD_LOWPASS,
+	ADI_FILTER_BIQUAD_HIGHPASS,
+	ADI_FILTER_BIQUAD_NOTCH
+};
+
+/* Biquad cascade (IIR) filter init parameters */
+struct adi_filter_biquad_init_param {
+	/* Number of 2nd order stages */
+	uint8_t num_stages;
+	/* Number of interleaved channels of the data */
+	uint8_t num_channels;
+	/* Coefficients {b0, b1, b2, a1, a2} of each stage, normalized to a0 = 1:
+	 * y[n] = b0*x[n] + b1*x[n-1] + b2*x[n-2] - a1*y[n-1] - a2*y[n-2] */
+	const float *coeffs;
+};
+
+/* Biquad cascade (IIR) filter descriptor */
+struct adi_filter_biquad {
+	/* Number of 2nd order stages */
+	uint8_t num_stages;
+	/* Number of interleaved channels of the data */
+	uint8_t num_channels;
+	/* Coefficients of each stage */
+	const float *coeffs;
+	/* Direct form II transposed state, 2 per stage of each channel */
+	float *state;
+};
+
+/* FIR (decimation) filter init parameters */
+struct adi_filter_fir_init_param {
+	/* Number of filter taps */
+	uint16_t num_taps;
+	/* Number of interleaved channels of the data */
+	uint8_t num_channels;
+	/* Decimation factor (1 for no decimation) */
+	uint8_t decimation;
+	/* Type of the filtered data */
+	enum adi_filter_data_type data_type;
+	/* Filter taps (|tap| < 2 for int32 data) */
+	const float *coeffs;
+};
+
+/* FIR (decimation) filter descriptor */
+struct adi_filter_fir {
+	/* Number of filter taps */
+	uint16_t num_taps;
+	/* Number of interleaved channels of the data */
+	uint8_t num_channels;
+	/* Decimation factor */
+	uint8_t decimation;
+	/* Type of the filtered data */
+	enum adi_filter_data_type data_type;
+	/* Filter taps */
+	const float *coeffs;
+	/* Filter taps in Q30 format, for int32 data */
+	int32_t *coeffs_q30;
+	/* Delay line of each channel, stored twice to avoid wrapping */
+	void *state;
+	/* Position of the newest sample into the delay lines */
+	uint16_t pos;
+	/* Input samples count since the last output sample */
+	uint8_t phase;
+};
+
+/* CIC decimation filter init parameters */
+struct adi_filter_cic_init_param {
+	/* Filter order (number of integrator and comb stages) */
+	uint8_t order;
+	/* Number of interleaved channels of the data */
+	uint8_t num_channels;
+	/* Decimation factor */
+	uint16_t decimation;
+};
+
+/* CIC decimation filter descriptor */
+struct adi_filter_cic {
+	/* Filter order (number of integrator and comb stages) */
+	uint8_t order;
+	/* Number of interleaved channels of the data */
+	uint8_t num_channels;
+	/* Decimation factor */
+	uint16_t decimation;
+	/* Filter DC gain (decimation ^ order) */
+	uint64_t gain;
+	/* Integrators followed by combs state of each channel */
+	uint64_t *state;
+	/* Input samples count since the last output sample */
+	uint16_t phase;
+};
+
+int adi_filter_biquad_design(enum adi_filter_biquad_type type, float fs,
+			     float f0, float q, float *coeffs);
+int adi_filter_biquad_init(struct adi_filter_biquad **desc,
+			   const struct adi_filter_biquad_init_param *param);
+int adi_filter_biquad_remove(struct adi_filter_biquad *desc);
+void adi_filter_biquad_reset(struct adi_filter_biquad *desc);
+int adi_filter_biquad_process_f32(struct adi_filter_biquad *desc,
+				  float *data, uint32_t frames);
+int adi_filter_biquad_process_i32(struct adi_filter_biquad *desc,
+				  int32_t *data, uint32_t frames);
+int adi_filter_biquad_cb(int32_t *data, uint16_t len, void *desc);
+
+int adi_filter_fir_init(struct adi_filter_fir **desc,
+			const struct adi_filter_fir_init_param *param);
+int adi_filter_fir_remove(struct adi_filter_fir *desc);
+void adi_filter_fir_reset(struct adi_filter_fir *desc);
+int32_t adi_filter_fir_process_f32(struct adi_filter_fir *desc,
+				   float *data, uint32_t frames);
+int32_t adi_filter_fir_process_i32(struct adi_filter_fir *desc,
+				   int32_t *data, uint32_t frames);
+int adi_filter_fir_cb(int32_t *data, uint16_t len, void *desc);
+
+int adi_filter_cic_init(struct adi_filter_cic **desc,
+			const struct adi_filter_cic_init_param *param);
+int adi_filter_cic_remove(struct adi_filter_cic *desc);
+void adi_filter_cic_reset(struct adi_filter_cic *desc);
+int32_t adi_filter_cic_process_i32(struct adi_filter_cic *desc,
+				   int32_t *data, uint32_t frames);
+
+#endif // !_ADI_FILTER_H_
@@ -20,6 +20,7 @@
 #include "pl_gui_views.h"
 #include "pl_gui_iio_wrapper.h"
 #include "adi_fft.h"
+#include "adi_fft_snapshot.h"
 #include "no_os_delay.h"
 #include "no_os_util.h"
 #include "no_os_error.h"
@@ -51,6 +52,9 @@
 /* DMM update counter. Update time = count value * lvgl tick time (msec) */
 #define PL_GUI_DMM_READ_CNT		10
 
+/* Number of samples of a channel unpacked at once for the capture display */
+#define PL_GUI_CAPTURE_BLOCK		64
+
 /******************************************************************************/
 /******************** Variables and User Defined Data Types *******************/
 /******************************************************************************/
@@ -155,6 +159,10 @@ bool pl_gui_capture_is_running;
 struct adi_fft_processing pl_gui_fft_proc;
 /* FFT measurement parameters */
 struct adi_fft_measurements pl_gui_fft_meas;
+/* FFT results published to the GUI and to the other readers */
+static struct adi_fft_snapshot *pl_gui_fft_snapshot;
+/* Copy of the latest FFT results displayed by the GUI */
+static struct adi_fft_snapshot_data pl_gui_fft_results;
 /* FFT channels select dropdown object */
 static lv_obj_t *pl_gui_fft_chn_select;
 /* FFT channels series for FFT view chart */
@@ -193,6 +201,11 @@ static adi_fft_data_to_volt_conv data_to_volt_wrt_vref;
  * binary data */
 static adi_fft_code_to_straight_bin_conv code_to_straight_binary;
 
+/* Local copy of the filter applied to the captured data and of its
+ * per channel contexts */
+static adi_fft_input_filter capture_filter;
+static void **capture_filter_ctx;
+
 /* Pocket Lab Instance */
 static struct pl_gui_init_param pl_instance =  {
 	.event1 = NULL,
@@ -453,98 +466,159 @@ static void pl_gui_rescale_data(int32_t *data)
 		(PL_GUI_CHART_MIN_PXL_RANGE);
 }
 
+/**
+ * @brief 	Get the format of the raw samples of a channel
+ * @param	chn[in] - Channel index
+ * @param	stride[in] - Bytes from a sample of the channel to the next one
+ * @param	format[out] - Raw samples format
+ * @return	None
+ */
+static void pl_gui_get_raw_format(uint32_t chn, uint16_t stride,
+				  struct adi_fft_raw_format *format)
+{
+	format->sign = pl_gui_capture_chn_info[chn]->sign;
+	format->realbits = pl_gui_capture_chn_info[chn]->realbits;
+	format->storagebits = pl_gui_capture_chn_info[chn]->storagebits;
+	format->shift = pl_gui_capture_chn_info[chn]->shift;
+	format->is_big_endian = pl_gui_capture_chn_info[chn]->is_big_endian;
+	format->stride = stride;
+	format->offset = *pl_gui_capture_offset[chn];
+	format->chn = chn;
+}
+
 /**
  * @brief 	Display the captured data onto GUI
  * @param	buf[in] - Data buffer
  * @param	rec_bytes[in] - Number of received bytes
  * @return	None
+ * @note	The samples are decoded the same way for the capture and the FFT
+ *		views (see adi_fft_unpack_raw()).
  */
 void pl_gui_display_captured_data(uint8_t *buf, uint32_t rec_bytes)
 {
 	char obuf[100];
 	uint32_t chn;
-	uint32_t indx = 0;
-	uint32_t storage_bytes;
-	uint32_t code;
-	int32_t data;
+	uint32_t indx;
+	uint32_t scan_bytes = 0;
+	uint32_t chn_offset = 0;
+	uint32_t samples;
+	uint32_t first, count;
+	int32_t block[PL_GUI_CAPTURE_BLOCK];
+	struct adi_fft_raw_format raw_format;
 	static uint32_t cnt = 0;
 
-	/* Copy data into local buffer */
-	while (indx < rec_bytes) {
-		if (pl_gui_capture_is_running) {
-			for (chn = 0; chn < pl_gui_capture_chn_cnt; chn++) {
-				if (lv_obj_get_state(pl_gui_capture_chn_checkbox[chn]) ==
-				    (LV_STATE_CHECKED | LV_STATE_DISABLED)) {
-					storage_bytes = pl_gui_capture_chn_info[chn]->storagebits >> 3;
-					memcpy((void *)&code, (void *)&buf[indx], storage_bytes);
-					/* Convert code to straight binary */
-					data = pl_gui_cnv_code_to_straight_binary(code, chn);
+	if (pl_gui_capture_is_running) {
+		/* Bytes of a scan, samples of the enabled channels interleaved */
+		for (chn = 0; chn < pl_gui_capture_chn_cnt; chn++) {
+			if (lv_obj_get_state(pl_gui_capture_chn_checkbox[chn]) ==
+			    (LV_STATE_CHECKED | LV_STATE_DISABLED)) {
+				scan_bytes += pl_gui_capture_chn_info[chn]->storagebits >> 3;
+			}
+		}
 
-					pl_gui_rescale_data(&data);
+		if (!scan_bytes) {
+			return;
+		}
+		samples = rec_bytes / scan_bytes;
+
+		for (chn = 0; chn < pl_gui_capture_chn_cnt; chn++) {
+			if (lv_obj_get_state(pl_gui_capture_chn_checkbox[chn]) !=
+			    (LV_STATE_CHECKED | LV_STATE_DISABLED)) {
+				continue;
+			}
+
+			pl_gui_get_raw_format(chn, scan_bytes, &raw_format);
+
+			/* Gather the samples of the channel by blocks */
+			for (first = 0; first < samples; first += count) {
+				count = samples - first;
+				if (count > PL_GUI_CAPTURE_BLOCK) {
+					count = PL_GUI_CAPTURE_BLOCK;
+				}
+
+				if (adi_fft_unpack_raw(&raw_format, code_to_straight_binary,
+						       &buf[chn_offset + first * scan_bytes],
+						       count, block)) {
+					return;
+				}
+
+				/* Filter the whole block at once, the filter state carrying over */
+				if (capture_filter) {
+					capture_filter(block, count,
+						       capture_filter_ctx ? capture_filter_ctx[chn] : NULL);
+				}
+
+				for (indx = 0; indx < count; indx++) {
+					pl_gui_rescale_data(&block[indx]);
 
 					lv_chart_set_next_value(pl_gui_capture_chart_ovrly,
 								pl_gui_capture_chn_ser[chn],
-								data);
+								block[indx]);
 				}
 			}
-		} else if (pl_gui_fft_is_running) {
-			chn = lv_dropdown_get_selected(pl_gui_fft_chn_select);
-			storage_bytes = pl_gui_capture_chn_info[chn]->storagebits >> 3;
-			memcpy((void *)&code, (void *)&buf[indx], storage_bytes);
-
-			/* Convert code to straight binary */
-			pl_gui_fft_proc.input_data[cnt++] = pl_gui_cnv_code_to_straight_binary(code,
-							    chn);
 
-			if (cnt >= fft_data_samples) {
-				break;
-			}
-		} else {
-			return;
+			chn_offset += raw_format.storagebits >> 3;
 		}
+	} else if (pl_gui_fft_is_running) {
+		chn = lv_dropdown_get_selected(pl_gui_fft_chn_select);
+		pl_gui_get_raw_format(chn, 0, &raw_format);
 
-		indx += storage_bytes;
+		/* Unpack the samples straight into the FFT input data */
+		samples = rec_bytes / (raw_format.storagebits >> 3);
+		if (samples > fft_data_samples - cnt) {
+			samples = fft_data_samples - cnt;
+		}
 
-		if (cnt >= fft_data_samples) {
-			break;
+		if (adi_fft_load_raw(&pl_gui_fft_proc, &raw_format, buf, cnt, samples)) {
+			return;
 		}
+		cnt += samples;
+	} else {
+		return;
 	}
 
 	if (pl_gui_fft_is_running && cnt >= fft_data_samples) {
 		/* Perform FFT measurements */
 		adi_fft_perform(&pl_gui_fft_proc, &pl_gui_fft_meas);
+		adi_fft_snapshot_publish(pl_gui_fft_snapshot, &pl_gui_fft_proc,
+					 &pl_gui_fft_meas);
+
+		/* Display FFT results, from a consistent copy of the latest ones */
+		if (pl_gui_read_fft_snapshot(&pl_gui_fft_results)) {
+			cnt = 0;
+			return;
+		}
 
-		/* Display FFT results */
-		for (cnt = 0; cnt < fft_bins; cnt++) {
+		for (cnt = 0; cnt < pl_gui_fft_results.num_bins; cnt++) {
 			lv_chart_set_next_value(pl_gui_fft_chart,
 						pl_gui_fft_chn_ser,
-						pl_gui_fft_proc.fft_dB[cnt]);
+						pl_gui_fft_results.spectrum[cnt]);
 		}
 
 		obuf[0] = '\0';
-		sprintf(obuf, "%.3f dB", pl_gui_fft_meas.THD);
+		sprintf(obuf, "%.3f dB", pl_gui_fft_results.meas.THD);
 		lv_label_set_text(thd_label, obuf);
 
 		obuf[0] = '\0';
-		sprintf(obuf, "%.3f dB", pl_gui_fft_meas.SNR);
+		sprintf(obuf, "%.3f dB", pl_gui_fft_results.meas.SNR);
 		lv_label_set_text(snr_label, obuf);
 
 		obuf[0] = '\0';
-		sprintf(obuf, "%.3f dB", pl_gui_fft_meas.DR);
+		sprintf(obuf, "%.3f dB", pl_gui_fft_results.meas.DR);
 		lv_label_set_text(dr_label, obuf);
 
 		obuf[0] = '\0';
-		sprintf(obuf, "%.3f dBFS", pl_gui_fft_meas.harmonics_mag_dbfs[0]);
+		sprintf(obuf, "%.3f dBFS", pl_gui_fft_results.meas.harmonics_mag_dbfs[0]);
 		lv_label_set_text(fund_power_label, obuf);
 
 		obuf[0] = '\0';
 		sprintf(obuf,
 			"%.3f Hz",
-			pl_gui_fft_meas.harmonics_freq[0]*pl_gui_fft_proc.bin_width);
+			pl_gui_fft_results.meas.harmonics_freq[0]*pl_gui_fft_results.bin_width);
 		lv_label_set_text(fund_freq_label, obuf);
 
 		obuf[0] = '\0';
-		sprintf(obuf, "%.3f uV", pl_gui_fft_meas.RMS_noise * 1000000.0);
+		sprintf(obuf, "%.3f uV", pl_gui_fft_results.meas.RMS_noise * 1000000.0);
 		lv_label_set_text(rms_noise_label, obuf);
 
 		if (pl_structure->event2 != 0) {
@@ -555,6 +629,28 @@ void pl_gui_display_captured_data(uint8_t *buf, uint32_t rec_bytes)
 	}
 }
 
+/**
+ * @brief 	Get a consistent copy of the latest FFT results
+ * @param	data[out] - FFT results
+ * @return	0 in case of success, negative error code otherwise
+ * @note	Safe to be called from any task, concurrently with the analysis.
+ */
+int32_t pl_gui_read_fft_snapshot(struct adi_fft_snapshot_data *data)
+{
+	return adi_fft_snapshot_read(pl_gui_fft_snapshot, data);
+}
+
+/**
+ * @brief 	Get the snapshot the FFT results are published to
+ * @return	Snapshot descriptor, NULL before the analysis view is created
+ * @note	To be passed to the readers of the FFT results, e.g. the FFT IIO
+ *		device (see adi_fft_iio.h).
+ */
+struct adi_fft_snapshot *pl_gui_get_fft_snapshot(void)
+{
+	return pl_gui_fft_snapshot;
+}
+
 /**
  * @brief 	Get the count for data samples to be captured
  * @return	data samples count
@@ -1906,6 +2002,10 @@ int32_t pl_gui_create_analysis_view(lv_obj_t *parent,
 	char dropdown_list[200];
 	lv_obj_t *start_btn;
 	lv_obj_t *label;
+	struct adi_fft_snapshot_init_param snapshot_param = {
+		/* Whole spectrum, one point of the chart per FFT bin */
+		.num_bins = param->device_params->fft_params->samples_count / 2
+	};
 
 	/* Get device names */
 	dropdown_list[0] = '\0';
@@ -2055,6 +2155,12 @@ int32_t pl_gui_create_analysis_view(lv_obj_t *parent,
 		param->view_extender->extend_analysis_view(parent);
 	}
 
+	/* Initialize the publication of the FFT results */
+	ret = adi_fft_snapshot_init(&pl_gui_fft_snapshot, &snapshot_param);
+	if (ret) {
+		return ret;
+	}
+
 	/* Initialize the FFT parameters */
 	return adi_fft_init(param->device_params->fft_params,
 			    &pl_gui_fft_proc,
@@ -2205,6 +2311,8 @@ int32_t pl_gui_init(struct pl_gui_desc **desc,
 		param->device_params->fft_params->convert_data_to_volt_wrt_vref;
 	code_to_straight_binary =
 		param->device_params->fft_params->convert_code_to_straight_binary;
+	capture_filter = param->device_params->capture_filter;
+	capture_filter_ctx = param->device_params->capture_filter_ctx;
 
 	fft_data_samples = param->device_params->fft_params->samples_count;
 	fft_bins = fft_data_samples / 2;
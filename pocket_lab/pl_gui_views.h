@@ -20,6 +20,7 @@
 #include <stdint.h>
 #include "lvgl/lvgl.h"
 #include "adi_fft.h"
+#include "adi_fft_snapshot.h"
 
 /******************************************************************************/
 /********************** Macros and Constants Definition ***********************/
@@ -76,6 +77,10 @@
 /* Pocket lab GUI device parameters */
 struct pl_gui_device_param {
 	struct adi_fft_init_params *fft_params;
+	/* Filter applied to the captured data before display (optional) */
+	adi_fft_input_filter capture_filter;
+	/* Context passed to the capture filter, one per channel */
+	void **capture_filter_ctx;
 };
 
 /* Pocket lab GUI init parameters */
@@ -130,6 +135,8 @@ int32_t pl_gui_create_about_view(lv_obj_t* parent,
 uint32_t get_data_samples_count(void);
 void pl_gui_get_capture_chns_mask(uint32_t *chn_mask);
 void pl_gui_display_captured_data(uint8_t *buf, uint32_t rec_bytes);
+int32_t pl_gui_read_fft_snapshot(struct adi_fft_snapshot_data *data);
+struct adi_fft_snapshot *pl_gui_get_fft_snapshot(void);
 bool pl_gui_is_dmm_running(void);
 bool pl_gui_is_capture_running(void);
 bool pl_gui_is_fft_running(void);
@@ -0,0 +1,195 @@
+/***************************************************************************//**
+ *   @file    adi_allan.c
+ *   @brief   Streaming Allan deviation implementation
+ *   @details Allan deviation at octave spaced tau (2^n sample periods) with a
+ *	      memory usage proportional to the number of octaves, i.e. log2 of
+ *	      the longest record length, whatever the monitoring time. The
+ *	      input data is averaged in a cascade of octaves, each of them
+ *	      keeping its last averages only. Allan differences at tau are
+ *	      computed every tau / 2 (50% overlap) from the averages of the
+ *	      octave below, except at the first tau which is fully overlapped.
+********************************************************************************
+ * Copyright (c) 2024 Analog Devices, Inc.
+ *
+ * This software is proprietary to Analog Devices, Inc. and its licensors.
+ * By using this software you agree to the terms of the associated
+ * Analog Devices Software License Agreement.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+#include "adi_allan.h"
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Initialize the Allan deviation estimator
+ * @param desc[out] - Allan deviation descriptor
+ * @param param[in] - Allan deviation init parameters
+ * @return 0 in case of success, negative error code otherwise
+ */
+int adi_allan_init(struct adi_allan **desc,
+		   const struct adi_allan_init_param *param)
+{
+	struct adi_allan *allan;
+
+	if (!desc || !param || param->sample_rate <= 0)
+		return -EINVAL;
+
+	allan = calloc(1, sizeof(*allan));
+	if (!allan)
+		return -ENOMEM;
+
+	allan->sample_rate = param->sample_rate;
+	allan->convert_data_to_volt = param->convert_data_to_volt;
+	allan->chn = param->chn;
+
+	*desc = allan;
+
+	return 0;
+}
+
+/**
+ * @brief Free the resources allocated by adi_allan_init()
+ * @param desc[in] - Allan deviation descriptor
+ * @return 0 in case of success, negative error code otherwise
+ */
+int adi_allan_remove(struct adi_allan *desc)
+{
+	if (!desc)
+		return -EINVAL;
+
+	free(desc);
+
+	return 0;
+}
+
+/**
+ * @brief Clear the data pushed so far
+ * @param desc[in,out] - Allan deviation descriptor
+ * @return none
+ */
+void adi_allan_reset(struct adi_allan *desc)
+{
+	if (!desc)
+		return;
+
+	memset(desc->octaves, 0, sizeof(desc->octaves));
+	memset(desc->taus, 0, sizeof(desc->taus));
+	desc->samples = 0;
+}
+
+/**
+ * @brief Push a sample through the averaging cascade
+ * @param desc[in,out] - Allan deviation descriptor
+ * @param value[in] - Sample value
+ * @return none
+ */
+static void adi_allan_push_sample(struct adi_allan *desc, double value)
+{
+	struct adi_allan_octave *oct;
+	struct adi_allan_tau *tau;
+	double avg = value, diff;
+	uint8_t cnt;
+
+	for (cnt = 0; cnt < ADI_ALLAN_MAX_TAU; cnt++) {
+		oct = &desc->octaves[cnt];
+
+		/* First tau, difference of consecutive samples */
+		if (!cnt && oct->history_count) {
+			diff = avg - oct->history[0];
+			desc->taus[0].sum_sq += diff * diff;
+			desc->taus[0].count++;
+		}
+
+		/* Tau of the next octave, difference of the averages of the last
+		 * two blocks pairs */
+		if (cnt + 1 < ADI_ALLAN_MAX_TAU && oct->history_count == 3) {
+			tau = &desc->taus[cnt + 1];
+			diff = ((avg + oct->history[0]) - (oct->history[1] + oct->history[2])) / 2.0;
+			tau->sum_sq += diff * diff;
+			tau->count++;
+		}
+
+		oct->history[2] = oct->history[1];
+		oct->history[1] = oct->history[0];
+		oct->history[0] = avg;
+		if (oct->history_count < 3)
+			oct->history_count++;
+
+		/* Blocks pairs averaged into the next octave */
+		if (!oct->half_valid) {
+			oct->half = avg;
+			oct->half_valid = true;
+			break;
+		}
+
+		avg = (oct->half + avg) / 2.0;
+		oct->half_valid = false;
+	}
+}
+
+/**
+ * @brief Push input data
+ * @param desc[in,out] - Allan deviation descriptor
+ * @param data[in] - Input data (straight binary, same as the FFT library)
+ * @param len[in] - Number of samples
+ * @return 0 in case of success, negative error code otherwise
+ */
+int adi_allan_push(struct adi_allan *desc, const int32_t *data, uint32_t len)
+{
+	uint32_t cnt;
+
+	if (!desc || !data)
+		return -EINVAL;
+
+	for (cnt = 0; cnt < len; cnt++) {
+		if (desc->convert_data_to_volt)
+			adi_allan_push_sample(desc, desc->convert_data_to_volt(data[cnt], desc->chn));
+		else
+			adi_allan_push_sample(desc, data[cnt]);
+	}
+
+	desc->samples += len;
+
+	return 0;
+}
+
+/**
+ * @brief Get the Allan deviation of the data pushed so far
+ * @param desc[in] - Allan deviation descriptor
+ * @param result[out] - Allan deviation at each tau with differences
+ * @return 0 in case of success, negative error code otherwise
+ */
+int adi_allan_get(struct adi_allan *desc, struct adi_allan_result *result)
+{
+	uint8_t cnt;
+
+	if (!desc || !result)
+		return -EINVAL;
+
+	result->count = 0;
+
+	for (cnt = 0; cnt < ADI_ALLAN_MAX_TAU; cnt++) {
+		if (!desc->taus[cnt].count)
+			break;
+
+		/* AVAR = 1/2 * mean of the squared differences */
+		result->tau[cnt] = (float)(1ULL << cnt) / desc->sample_rate;
+		result->adev[cnt] = sqrt(desc->taus[cnt].sum_sq /
+					 (2.0 * desc->taus[cnt].count));
+		result->diffs[cnt] = (desc->taus[cnt].count > UINT32_MAX) ? UINT32_MAX :
+				     desc->taus[cnt].count;
+		result->count++;
+	}
+
+	return 0;
+}
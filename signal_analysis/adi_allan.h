@@ -0,0 +1,104 @@
+/*************************************************************************//**
+ *   @file   adi_allan.h
+ *   @brief  Streaming Allan deviation headers
+******************************************************************************
+* Copyright (c) 2024 Analog Devices, Inc.
+* All rights reserved.
+*
+* This software is proprietary to Analog Devices, Inc. and its licensors.
+* By using this software you agree to the terms of the associated
+* Analog Devices Software License Agreement.
+*****************************************************************************/
+
+#ifndef _ADI_ALLAN_H_
+#define _ADI_ALLAN_H_
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/******************************************************************************/
+/************************ Macros/Constants ************************************/
+/******************************************************************************/
+
+/* Max number of octave spaced tau, tau = 2^n sample periods */
+#if !defined(ADI_ALLAN_MAX_TAU)
+#define ADI_ALLAN_MAX_TAU	32
+#endif
+
+/******************************************************************************/
+/************************ Public Declarations *********************************/
+/******************************************************************************/
+
+typedef float(*adi_allan_data_to_volt_conv)(int32_t, uint8_t);
+
+/* Allan deviation init parameters */
+struct adi_allan_init_param {
+	/* Sample rate of the input data in Hz */
+	float sample_rate;
+	/* Convert the input data to volts, same as the FFT library (optional,
+	 * results are in codes if not set) */
+	adi_allan_data_to_volt_conv convert_data_to_volt;
+	/* Channel passed to the conversion function */
+	uint8_t chn;
+};
+
+/* Octave of the averaging cascade, blocks of 2^n samples */
+struct adi_allan_octave {
+	/* Last averages of blocks of 2^n samples, newest first */
+	double history[3];
+	/* Number of valid averages in the history */
+	uint8_t history_count;
+	/* Average of the first half of the next octave block */
+	double half;
+	/* Half of the next octave block available */
+	bool half_valid;
+};
+
+/* Allan variance accumulator of a tau */
+struct adi_allan_tau {
+	/* Sum of the squared differences of the averages */
+	double sum_sq;
+	/* Number of differences */
+	uint64_t count;
+};
+
+/* Allan deviation descriptor */
+struct adi_allan {
+	/* Sample rate of the input data in Hz */
+	float sample_rate;
+	/* Convert the input data to volts */
+	adi_allan_data_to_volt_conv convert_data_to_volt;
+	/* Channel passed to the conversion function */
+	uint8_t chn;
+	/* Averaging cascade */
+	struct adi_allan_octave octaves[ADI_ALLAN_MAX_TAU];
+	/* Allan variance accumulators */
+	struct adi_allan_tau taus[ADI_ALLAN_MAX_TAU];
+	/* Number of samples pushed */
+	uint64_t samples;
+};
+
+/* Allan deviation of the data pushed so far */
+struct adi_allan_result {
+	/* Number of tau */
+	uint8_t count;
+	/* Tau in seconds */
+	float tau[ADI_ALLAN_MAX_TAU];
+	/* Allan deviation, in volts or codes */
+	float adev[ADI_ALLAN_MAX_TAU];
+	/* Number of averaged differences, for the confidence of the estimate */
+	uint32_t diffs[ADI_ALLAN_MAX_TAU];
+};
+
+int adi_allan_init(struct adi_allan **desc,
+		   const struct adi_allan_init_param *param);
+int adi_allan_remove(struct adi_allan *desc);
+void adi_allan_reset(struct adi_allan *desc);
+int adi_allan_push(struct adi_allan *desc, const int32_t *data, uint32_t len);
+int adi_allan_get(struct adi_allan *desc, struct adi_allan_result *result);
+
+#endif	// !_ADI_ALLAN_H_
@@ -0,0 +1,296 @@
+/***************************************************************************//**
+ *   @file    adi_step_response.c
+ *   @brief   Step response analysis implementation
+ *   @details Rise time, slew rate, overshoot and settling time of the steps
+ *	      captured from a square wave input. Edges are detected with
+ *	      hysteresis around the middle of the capture range. The levels
+ *	      before and after each step are averaged in the middle of the
+ *	      flat segments between edges, so the steps must settle within half
+ *	      of the segment to be measured.
+********************************************************************************
+ * Copyright (c) 2024 Analog Devices, Inc.
+ *
+ * This software is proprietary to Analog Devices, Inc. and its licensors.
+ * By using this software you agree to the terms of the associated
+ * Analog Devices Software License Agreement.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+#include "adi_step_response.h"
+
+/******************************************************************************/
+/******************** Variables and User Defined Data Types *******************/
+/******************************************************************************/
+
+/* Number of samples checked at once by the edges scan */
+#define ADI_STEP_RESPONSE_SCAN_BLOCK	16
+
+/* Shortest segment between edges, in samples */
+#define ADI_STEP_RESPONSE_MIN_SEGMENT	8
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Check if a block of samples stays on one side of a threshold
+ * @param data[in] - Block of samples
+ * @param len[in] - Number of samples
+ * @param threshold[in] - Threshold
+ * @param high[in] - Check the samples are below (high false) or above
+ *		     (high true) the threshold
+ * @return true if no sample of the block crosses the threshold
+ * @note Branchless min/max reduction, so that the scan of the flat segments
+ *	 is vectorized by the compiler where the target allows it.
+ */
+static bool adi_step_response_block_idle(const int32_t *data, uint32_t len,
+		int32_t threshold, bool high)
+{
+	int32_t min = data[0], max = data[0];
+	uint32_t cnt;
+
+	for (cnt = 1; cnt < len; cnt++) {
+		min = (data[cnt] < min) ? data[cnt] : min;
+		max = (data[cnt] > max) ? data[cnt] : max;
+	}
+
+	return high ? (min > threshold) : (max < threshold);
+}
+
+/**
+ * @brief Find the edges of the capture
+ * @param data[in] - Input data
+ * @param len[in] - Number of samples
+ * @param hysteresis[in] - Hysteresis, fraction of the capture range
+ * @param edges[out] - Position of the 50% crossing of each edge
+ * @param rising[out] - Direction of each edge
+ * @return Number of edges
+ */
+static uint8_t adi_step_response_find_edges(const int32_t *data, uint32_t len,
+		float hysteresis, float *edges, bool *rising)
+{
+	int32_t min, max, lower, upper;
+	double mid;
+	uint32_t cnt, block, back;
+	uint8_t count = 0;
+	bool high;
+
+	min = max = data[0];
+	for (cnt = 1; cnt < len; cnt++) {
+		min = (data[cnt] < min) ? data[cnt] : min;
+		max = (data[cnt] > max) ? data[cnt] : max;
+	}
+	if (max == min)
+		return 0;
+
+	mid = ((double)min + max) / 2.0;
+	upper = mid + hysteresis * ((double)max - min) / 2.0;
+	lower = mid - hysteresis * ((double)max - min) / 2.0;
+	high = data[0] >= mid;
+
+	for (block = 0; block < len && count < ADI_STEP_RESPONSE_MAX_EDGES;
+	     block += ADI_STEP_RESPONSE_SCAN_BLOCK) {
+		/* Skip the blocks without crossing */
+		if (adi_step_response_block_idle(&data[block],
+						 (len - block < ADI_STEP_RESPONSE_SCAN_BLOCK) ?
+						 len - block : ADI_STEP_RESPONSE_SCAN_BLOCK,
+						 high ? lower : upper, high))
+			continue;
+
+		for (cnt = block; cnt < block + ADI_STEP_RESPONSE_SCAN_BLOCK && cnt < len;
+		     cnt++) {
+			if (high ? (data[cnt] >= lower) : (data[cnt] <= upper))
+				continue;
+
+			/* Edge, interpolated 50% crossing searched backwards */
+			high = !high;
+			for (back = cnt; back > 0; back--) {
+				if (high ? (data[back - 1] < mid) : (data[back - 1] > mid))
+					break;
+			}
+			if (back)
+				edges[count] = back - 1 + (mid - data[back - 1]) /
+					       ((double)data[back] - data[back - 1]);
+			else
+				edges[count] = 0;
+			rising[count] = high;
+
+			count++;
+			if (count == ADI_STEP_RESPONSE_MAX_EDGES)
+				break;
+		}
+	}
+
+	return count;
+}
+
+/**
+ * @brief Average level in the middle of a segment between edges
+ * @param data[in] - Input data
+ * @param start[in] - Segment start
+ * @param end[in] - Segment end
+ * @return Level in codes
+ */
+static float adi_step_response_level(const int32_t *data, float start,
+				     float end)
+{
+	const uint32_t first = ceilf(start + (end - start) / 2);
+	const uint32_t last = floorf(start + (end - start) * 7 / 8);
+	double sum = 0.0;
+	uint32_t cnt;
+
+	for (cnt = first; cnt <= last; cnt++)
+		sum += data[cnt];
+
+	return sum / (last - first + 1);
+}
+
+/**
+ * @brief Measure the response to a step
+ * @param param[in] - Step response analysis parameters
+ * @param data[in] - Input data
+ * @param start[in] - Start of the segment before the edge
+ * @param end[in] - End of the segment after the edge
+ * @param edge[in,out] - Step response, position and direction set
+ * @return 0 in case of success, negative error code otherwise
+ */
+static int adi_step_response_edge(const struct adi_step_response_param *param,
+				  const int32_t *data, float start, float end,
+				  struct adi_step_response_edge *edge)
+{
+	const uint32_t pos = edge->position;
+	const uint32_t level_start = ceilf(edge->position + (end - edge->position) / 2);
+	/* End of the level window, before the next edge */
+	const uint32_t last = floorf(edge->position + (end - edge->position) * 7 / 8);
+	float step, norm, prev_norm, t10, t90, band;
+	uint32_t cnt, unsettled;
+
+	edge->initial = adi_step_response_level(data, start, edge->position);
+	edge->final = adi_step_response_level(data, edge->position, end);
+	step = edge->final - edge->initial;
+	if (step == 0 || (step > 0) != edge->rising)
+		return -EINVAL;
+
+	/* 10% crossing, backwards from the edge */
+	t10 = start;
+	for (cnt = pos; cnt > start; cnt--) {
+		norm = (data[cnt - 1] - edge->initial) / step;
+		if (norm <= 0.1) {
+			prev_norm = (data[cnt] - edge->initial) / step;
+			t10 = cnt - 1 + (0.1 - norm) / (prev_norm - norm);
+			break;
+		}
+	}
+
+	/* 90% crossing, forwards from the edge */
+	t90 = end;
+	for (cnt = pos + 1; cnt <= last; cnt++) {
+		norm = (data[cnt] - edge->initial) / step;
+		if (norm >= 0.9) {
+			prev_norm = (data[cnt - 1] - edge->initial) / step;
+			t90 = cnt - 1 + (0.9 - prev_norm) / (norm - prev_norm);
+			break;
+		}
+	}
+
+	edge->rise_time = (t90 - t10) / param->sample_rate;
+	edge->slew_rate = (edge->rise_time > 0) ? 0.8 * step / edge->rise_time : 0.0;
+
+	/* Overshoot and last sample out of the error band */
+	band = param->error_band * fabsf(step);
+	edge->overshoot = 0.0;
+	unsettled = pos;
+	for (cnt = pos; cnt <= last; cnt++) {
+		norm = (data[cnt] - edge->final) / step * 100.0;
+		if (norm > edge->overshoot)
+			edge->overshoot = norm;
+		if (fabsf(data[cnt] - edge->final) > band)
+			unsettled = cnt;
+	}
+
+	edge->settling_time = (unsettled + 1 - edge->position) / param->sample_rate;
+	edge->settled = unsettled < level_start;
+
+	return 0;
+}
+
+/**
+ * @brief Analyze the step responses of a capture
+ * @param param[in] - Step response analysis parameters
+ * @param data[in] - Input data (straight binary for ADCs), e.g. the input data
+ *		     of the FFT processing
+ * @param len[in] - Number of samples
+ * @param result[out] - Response to each step and aggregated results
+ * @return 0 in case of success, negative error code otherwise
+ * @note Edges too close to each other or to the capture limits, to have their
+ *	 levels measured, are ignored.
+ */
+int adi_step_response_analyze(const struct adi_step_response_param *param,
+			      const int32_t *data, uint32_t len,
+			      struct adi_step_response_result *result)
+{
+	float edges[ADI_STEP_RESPONSE_MAX_EDGES];
+	bool rising[ADI_STEP_RESPONSE_MAX_EDGES];
+	struct adi_step_response_edge *edge;
+	float start, end;
+	uint8_t count, cnt;
+
+	if (!param || !data || !result || param->sample_rate <= 0
+	    || param->error_band <= 0 || param->hysteresis < 0
+	    || param->hysteresis >= 1)
+		return -EINVAL;
+
+	memset(result, 0, sizeof(*result));
+
+	count = adi_step_response_find_edges(data, len, param->hysteresis, edges,
+					     rising);
+
+	for (cnt = 0; cnt < count; cnt++) {
+		start = cnt ? edges[cnt - 1] : 0;
+		end = (cnt + 1 < count) ? edges[cnt + 1] : len;
+		if (edges[cnt] - start < ADI_STEP_RESPONSE_MIN_SEGMENT
+		    || end - edges[cnt] < ADI_STEP_RESPONSE_MIN_SEGMENT)
+			continue;
+
+		edge = &result->edges[result->count];
+		edge->position = edges[cnt];
+		edge->rising = rising[cnt];
+		if (adi_step_response_edge(param, data, start, end, edge))
+			continue;
+
+		result->count++;
+		if (edge->rising)
+			result->rising_count++;
+
+		result->rise_time_mean += edge->rise_time;
+		result->overshoot_mean += edge->overshoot;
+		result->slew_rate_mean += fabsf(edge->slew_rate);
+		if (edge->rise_time > result->rise_time_max)
+			result->rise_time_max = edge->rise_time;
+		if (edge->overshoot > result->overshoot_max)
+			result->overshoot_max = edge->overshoot;
+
+		if (edge->settled) {
+			result->settled_count++;
+			result->settling_time_mean += edge->settling_time;
+			if (edge->settling_time > result->settling_time_max)
+				result->settling_time_max = edge->settling_time;
+		}
+	}
+
+	if (result->count) {
+		result->rise_time_mean /= result->count;
+		result->overshoot_mean /= result->count;
+		result->slew_rate_mean /= result->count;
+	}
+	if (result->settled_count)
+		result->settling_time_mean /= result->settled_count;
+
+	return 0;
+}
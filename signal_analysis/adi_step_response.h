@@ -0,0 +1,95 @@
+/*************************************************************************//**
+ *   @file   adi_step_response.h
+ *   @brief  Step response analysis headers
+******************************************************************************
+* Copyright (c) 2024 Analog Devices, Inc.
+* All rights reserved.
+*
+* This software is proprietary to Analog Devices, Inc. and its licensors.
+* By using this software you agree to the terms of the associated
+* Analog Devices Software License Agreement.
+*****************************************************************************/
+
+#ifndef _ADI_STEP_RESPONSE_H_
+#define _ADI_STEP_RESPONSE_H_
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/******************************************************************************/
+/************************ Macros/Constants ************************************/
+/******************************************************************************/
+
+/* Max number of analyzed edges in a capture */
+#if !defined(ADI_STEP_RESPONSE_MAX_EDGES)
+#define ADI_STEP_RESPONSE_MAX_EDGES	32
+#endif
+
+/******************************************************************************/
+/************************ Public Declarations *********************************/
+/******************************************************************************/
+
+/* Step response analysis parameters */
+struct adi_step_response_param {
+	/* Sample rate of the input data in Hz */
+	float sample_rate;
+	/* Settling error band, fraction of the step amplitude (e.g. 0.001) */
+	float error_band;
+	/* Edge detection hysteresis, fraction of the capture range (e.g. 0.1) */
+	float hysteresis;
+};
+
+/* Response to a single step */
+struct adi_step_response_edge {
+	/* Position of the 50% crossing in samples */
+	float position;
+	/* Rising edge */
+	bool rising;
+	/* Level before the step in codes */
+	float initial;
+	/* Level after the step in codes */
+	float final;
+	/* 10% to 90% rise (or fall) time in seconds */
+	float rise_time;
+	/* Slew rate in codes per second, over the 10% to 90% range */
+	float slew_rate;
+	/* Overshoot in percent of the step amplitude */
+	float overshoot;
+	/* Time from the 50% crossing to the error band in seconds */
+	float settling_time;
+	/* Settled within the error band before the next step */
+	bool settled;
+};
+
+/* Step response analysis result */
+struct adi_step_response_result {
+	/* Number of analyzed edges */
+	uint8_t count;
+	/* Number of rising edges */
+	uint8_t rising_count;
+	/* Number of settled edges */
+	uint8_t settled_count;
+	/* Response to each step */
+	struct adi_step_response_edge edges[ADI_STEP_RESPONSE_MAX_EDGES];
+	/* Mean and worst rise time in seconds */
+	float rise_time_mean;
+	float rise_time_max;
+	/* Mean and worst overshoot in percent */
+	float overshoot_mean;
+	float overshoot_max;
+	/* Mean and worst settling time of the settled edges in seconds */
+	float settling_time_mean;
+	float settling_time_max;
+	/* Mean slew rate magnitude in codes per second */
+	float slew_rate_mean;
+};
+
+int adi_step_response_analyze(const struct adi_step_response_param *param,
+			      const int32_t *data, uint32_t len,
+			      struct adi_step_response_result *result);
+
+#endif	// !_ADI_STEP_RESPONSE_H_
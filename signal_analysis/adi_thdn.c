@@ -0,0 +1,365 @@
+/***************************************************************************//**
+ *   @file    adi_thdn.c
+ *   @brief   Streaming THD+N analyzer implementation
+ *   @details THD+N measured in the time domain the way analog audio analyzers
+ *	      do, continuously and without framing. The DC is removed, the
+ *	      fundamental is rejected by a second order IIR notch (constrained
+ *	      poles, high Q) tracking its frequency, and the RMS of the signal
+ *	      and of the notch output are exponentially averaged. The
+ *	      fundamental is first acquired from the period of the zero
+ *	      crossings of the DC blocked input, so that no initial estimate is
+ *	      needed. Once locked, the notch coefficient follows the fundamental
+ *	      by a normalized gradient descent of the notch output power, which
+ *	      converges to the exact frequency of a tone whatever the number of
+ *	      samples per period.
+********************************************************************************
+ * Copyright (c) 2024 Analog Devices, Inc.
+ *
+ * This software is proprietary to Analog Devices, Inc. and its licensors.
+ * By using this software you agree to the terms of the associated
+ * Analog Devices Software License Agreement.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdlib.h>
+#include <math.h>
+#include <errno.h>
+#include "adi_thdn.h"
+
+/******************************************************************************/
+/******************** Variables and User Defined Data Types *******************/
+/******************************************************************************/
+
+#define ADI_THDN_PI		3.14159265358979323846
+
+/* DC blocker corner, relative to the tracked fundamental frequency */
+#define ADI_THDN_DC_CORNER	0.02
+
+/* DC blocker corner until the fundamental is acquired, relative to the
+ * sample rate */
+#define ADI_THDN_DC_ACQ_CORNER	0.0001
+
+/* Number of periods of an acquisition estimate */
+#define ADI_THDN_ACQ_CYCLES	4
+
+/* Max difference of two successive acquisition estimates for the fundamental
+ * to be locked, the DC blocker start-up transient being settled */
+#define ADI_THDN_ACQ_TOLERANCE	0.02
+
+/* Hysteresis of the acquisition zero crossings, relative to the RMS */
+#define ADI_THDN_ACQ_HYSTERESIS	0.1
+
+/* Number of time constants for the averages to settle, the start-up
+ * transient power being attenuated by 65 dB */
+#define ADI_THDN_SETTLING_TC	15
+
+/* Max change of the tracked frequency over a time constant for the notch
+ * to be converged, relative to the notch bandwidth */
+#define ADI_THDN_CONVERGED_BW	0.001
+
+/* Limit of the notch coefficient, keeping the notch frequency above 0 and
+ * below fs / 2 */
+#define ADI_THDN_A_LIMIT	1.999999
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Initialize the THD+N analyzer
+ * @param desc[out] - THD+N analyzer descriptor
+ * @param param[in] - THD+N analyzer init parameters
+ * @return 0 in case of success, negative error code otherwise
+ */
+int adi_thdn_init(struct adi_thdn **desc,
+		  const struct adi_thdn_init_param *param)
+{
+	struct adi_thdn *thdn;
+
+	if (!desc || !param || param->sample_rate <= 0 || param->notch_bw <= 0
+	    || param->time_constant <= 0 || param->adapt_rate < 0
+	    || param->adapt_rate > 1 || param->fund_freq < 0
+	    || param->fund_freq >= param->sample_rate / 2)
+		return -EINVAL;
+
+	/* A fixed notch needs the fundamental frequency */
+	if (!param->adapt_rate && !param->fund_freq)
+		return -EINVAL;
+
+	thdn = calloc(1, sizeof(*thdn));
+	if (!thdn)
+		return -ENOMEM;
+
+	thdn->sample_rate = param->sample_rate;
+	thdn->rho = 1.0 - ADI_THDN_PI * param->notch_bw / param->sample_rate;
+	thdn->fund_init = param->fund_freq / param->sample_rate;
+	thdn->adapt_rate = param->adapt_rate;
+	thdn->alpha = 1.0 - exp(-1.0 / (param->time_constant * param->sample_rate));
+	thdn->settling_samples = ADI_THDN_SETTLING_TC * (param->time_constant +
+				 1.0 / (ADI_THDN_PI * param->notch_bw)) * param->sample_rate;
+	thdn->check_samples = param->time_constant * param->sample_rate;
+	thdn->converged_tol = ADI_THDN_CONVERGED_BW * param->notch_bw /
+			      param->sample_rate;
+
+	adi_thdn_reset(thdn);
+
+	*desc = thdn;
+
+	return 0;
+}
+
+/**
+ * @brief Free the resources allocated by adi_thdn_init()
+ * @param desc[in] - THD+N analyzer descriptor
+ * @return 0 in case of success, negative error code otherwise
+ */
+int adi_thdn_remove(struct adi_thdn *desc)
+{
+	if (!desc)
+		return -EINVAL;
+
+	free(desc);
+
+	return 0;
+}
+
+/**
+ * @brief Set the notch and DC blocker frequencies
+ * @param desc[in,out] - THD+N analyzer descriptor
+ * @param freq[in] - Fundamental frequency, cycles per sample
+ * @return none
+ */
+static void adi_thdn_set_freq(struct adi_thdn *desc, double freq)
+{
+	desc->freq = freq;
+	desc->a = -2.0 * cos(2.0 * ADI_THDN_PI * freq);
+	if (desc->a > ADI_THDN_A_LIMIT)
+		desc->a = ADI_THDN_A_LIMIT;
+	else if (desc->a < -ADI_THDN_A_LIMIT)
+		desc->a = -ADI_THDN_A_LIMIT;
+
+	desc->dc_pole = 1.0 - 2.0 * ADI_THDN_PI * ADI_THDN_DC_CORNER * freq;
+}
+
+/**
+ * @brief Restart the analysis, the fundamental being acquired again
+ * @param desc[in,out] - THD+N analyzer descriptor
+ * @return none
+ */
+void adi_thdn_reset(struct adi_thdn *desc)
+{
+	if (!desc)
+		return;
+
+	if (desc->adapt_rate) {
+		/* Notch at the initial estimate, or at fs / 4 without estimate, and
+		 * low DC blocker corner until the fundamental is acquired */
+		adi_thdn_set_freq(desc, desc->fund_init ? desc->fund_init : 0.25);
+		desc->dc_pole = 1.0 - 2.0 * ADI_THDN_PI * ADI_THDN_DC_ACQ_CORNER;
+		desc->locked = false;
+	} else {
+		adi_thdn_set_freq(desc, desc->fund_init);
+		desc->locked = true;
+	}
+
+	desc->acq_period = 0.0;
+	desc->acq_crossings = 0;
+	desc->armed = false;
+	desc->stable_sample = 0;
+	desc->check_sample = 0;
+	desc->check_freq = desc->freq;
+	desc->dc_x1 = 0;
+	desc->dc_y1 = 0.0;
+	desc->xf1 = 0.0;
+	desc->xf2 = 0.0;
+	desc->ms_notch = 0.0;
+	desc->fund1 = 0.0;
+	desc->last_crossing = 0.0;
+	desc->ms_total = 0.0;
+	desc->ms_residual = 0.0;
+	desc->samples = 0;
+}
+
+/**
+ * @brief Track the fundamental frequency by a gradient descent of the notch
+ *	  output power
+ * @param desc[in,out] - THD+N analyzer descriptor
+ * @param e[in] - Notch output sample
+ * @return none
+ * @note For a tone, the notch output is (a + 2 * cos(w)) times the previous
+ *	 all-pole section output, the normalized gradient update removing the
+ *	 coefficient error by adapt_rate per period, without bias.
+ */
+static void adi_thdn_track(struct adi_thdn *desc, double e)
+{
+	const double xf1_2 = desc->xf1 * desc->xf1;
+	double norm;
+
+	/* Power of the all-pole section output over about a period, never
+	 * below the current sample for the update to stay stable */
+	desc->ms_notch += desc->freq * (xf1_2 - desc->ms_notch);
+	norm = desc->ms_notch > xf1_2 ? desc->ms_notch : xf1_2;
+	if (norm <= 0)
+		return;
+
+	desc->a -= desc->adapt_rate * desc->freq * e * desc->xf1 / norm;
+	if (desc->a > ADI_THDN_A_LIMIT)
+		desc->a = ADI_THDN_A_LIMIT;
+	else if (desc->a < -ADI_THDN_A_LIMIT)
+		desc->a = -ADI_THDN_A_LIMIT;
+}
+
+/**
+ * @brief Check the convergence of the tracked frequency once per time
+ *	  constant
+ * @param desc[in,out] - THD+N analyzer descriptor
+ * @param pos[in] - Position of the sample
+ * @return none
+ * @note The averages settling is restarted while the frequency still moves.
+ */
+static void adi_thdn_check(struct adi_thdn *desc, uint64_t pos)
+{
+	if (pos - desc->check_sample < desc->check_samples)
+		return;
+
+	desc->freq = acos(-desc->a / 2.0) / (2.0 * ADI_THDN_PI);
+	if (fabs(desc->freq - desc->check_freq) > desc->converged_tol)
+		desc->stable_sample = pos;
+
+	desc->check_freq = desc->freq;
+	desc->check_sample = pos;
+}
+
+/**
+ * @brief Acquire the fundamental frequency from the period of the input
+ * @param desc[in,out] - THD+N analyzer descriptor
+ * @param y[in] - DC blocked input sample
+ * @param pos[in] - Position of the sample
+ * @return none
+ * @note The fundamental being the largest component of the input, its rising
+ *	 zero crossings (with hysteresis against the noise) give a coarse
+ *	 frequency estimate, close enough for the notch tracking to lock
+ *	 whatever the initial frequency.
+ */
+static void adi_thdn_acquire(struct adi_thdn *desc, double y, double pos)
+{
+	const double hysteresis = ADI_THDN_ACQ_HYSTERESIS * sqrt(desc->ms_total);
+	double crossing, period;
+
+	if (y < -hysteresis)
+		desc->armed = true;
+	else if (desc->armed && y >= 0) {
+		/* Rising zero crossing, linearly interpolated */
+		desc->armed = false;
+		crossing = pos - y / (y - desc->fund1);
+
+		if (!desc->acq_crossings)
+			desc->last_crossing = crossing;
+
+		if (desc->acq_crossings++ == ADI_THDN_ACQ_CYCLES) {
+			period = (crossing - desc->last_crossing) / ADI_THDN_ACQ_CYCLES;
+
+			if (period > 2.0 && desc->acq_period > 0
+			    && fabs(period - desc->acq_period) <=
+			    ADI_THDN_ACQ_TOLERANCE * period) {
+				/* Locked, switching to the notch tracking */
+				adi_thdn_set_freq(desc, 1.0 / period);
+				desc->locked = true;
+				desc->stable_sample = pos;
+				desc->check_sample = pos;
+				desc->check_freq = desc->freq;
+				return;
+			}
+
+			desc->acq_period = period;
+			desc->last_crossing = crossing;
+			desc->acq_crossings = 1;
+		}
+	}
+
+	desc->fund1 = y;
+}
+
+/**
+ * @brief Process a block of input data
+ * @param desc[in,out] - THD+N analyzer descriptor
+ * @param data[in] - Input data (straight binary for ADCs)
+ * @param len[in] - Number of samples
+ * @return 0 in case of success, negative error code otherwise
+ */
+int adi_thdn_process(struct adi_thdn *desc, const int32_t *data, uint32_t len)
+{
+	const double rho2 = desc ? desc->rho * desc->rho : 0.0;
+	double y, xf, e;
+	uint32_t cnt;
+
+	if (!desc || !data)
+		return -EINVAL;
+
+	for (cnt = 0; cnt < len; cnt++) {
+		/* No step at the first sample */
+		if (!desc->samples && !cnt)
+			desc->dc_x1 = data[0];
+
+		/* DC blocker */
+		y = (double)(data[cnt] - desc->dc_x1) + desc->dc_pole * desc->dc_y1;
+		desc->dc_x1 = data[cnt];
+		desc->dc_y1 = y;
+
+		/* Notch, all-pole section then zeros on the unit circle */
+		xf = y - desc->rho * desc->a * desc->xf1 - rho2 * desc->xf2;
+		e = xf + desc->a * desc->xf1 + desc->xf2;
+
+		/* Fundamental acquisition, then notch frequency tracking */
+		if (!desc->locked) {
+			adi_thdn_acquire(desc, y, (double)(desc->samples + cnt));
+		} else if (desc->adapt_rate) {
+			adi_thdn_track(desc, e);
+			adi_thdn_check(desc, desc->samples + cnt);
+		}
+
+		desc->xf2 = desc->xf1;
+		desc->xf1 = xf;
+
+		/* Mean squares of the signal and of the harmonics and noise */
+		desc->ms_total += desc->alpha * (y * y - desc->ms_total);
+		desc->ms_residual += desc->alpha * (e * e - desc->ms_residual);
+	}
+
+	desc->samples += len;
+
+	return 0;
+}
+
+/**
+ * @brief Get the THD+N of the data processed so far
+ * @param desc[in] - THD+N analyzer descriptor
+ * @param result[out] - THD+N analyzer result
+ * @return 0 in case of success, negative error code otherwise
+ */
+int adi_thdn_get(struct adi_thdn *desc, struct adi_thdn_result *result)
+{
+	double ratio;
+
+	if (!desc || !result)
+		return -EINVAL;
+
+	if (desc->ms_total <= 0)
+		return -EAGAIN;
+
+	ratio = sqrt(desc->ms_residual / desc->ms_total);
+
+	result->thdn_db = 20.0 * log10(ratio);
+	result->thdn_percent = 100.0 * ratio;
+	result->fund_freq = acos(-desc->a / 2.0) * desc->sample_rate /
+			    (2.0 * ADI_THDN_PI);
+	result->rms_total = sqrt(desc->ms_total);
+	result->rms_residual = sqrt(desc->ms_residual);
+	result->settled = desc->locked &&
+			  desc->samples - desc->stable_sample >= desc->settling_samples;
+
+	return 0;
+}
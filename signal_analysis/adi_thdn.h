@@ -0,0 +1,128 @@
+/*************************************************************************//**
+ *   @file   adi_thdn.h
+ *   @brief  Streaming THD+N analyzer headers
+******************************************************************************
+* Copyright (c) 2024 Analog Devices, Inc.
+* All rights reserved.
+*
+* This software is proprietary to Analog Devices, Inc. and its licensors.
+* By using this software you agree to the terms of the associated
+* Analog Devices Software License Agreement.
+*****************************************************************************/
+
+#ifndef _ADI_THDN_H_
+#define _ADI_THDN_H_
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/******************************************************************************/
+/************************ Public Declarations *********************************/
+/******************************************************************************/
+
+/* THD+N analyzer init parameters */
+struct adi_thdn_init_param {
+	/* Sample rate of the input data in Hz */
+	float sample_rate;
+	/* Fundamental frequency in Hz, required with a fixed notch. With notch
+	 * adaptation, the fundamental is acquired from the input and this is
+	 * only the notch frequency until then (0 = fs / 4) */
+	float fund_freq;
+	/* -3 dB bandwidth of the notch in Hz */
+	float notch_bw;
+	/* Adaptation rate of the notch frequency (0 to 1, e.g. 0.01), fraction
+	 * of the frequency error removed per period, 0 to keep the notch at the
+	 * initial frequency */
+	float adapt_rate;
+	/* Time constant of the RMS averaging in seconds */
+	float time_constant;
+};
+
+/* THD+N analyzer descriptor */
+struct adi_thdn {
+	/* Sample rate of the input data in Hz */
+	float sample_rate;
+	/* DC blocker pole */
+	double dc_pole;
+	/* Notch pole radius */
+	double rho;
+	/* Notch coefficient, -2 * cos(w0) */
+	double a;
+	/* Initial fundamental frequency, cycles per sample */
+	double fund_init;
+	/* Adaptation rate of the notch frequency */
+	double adapt_rate;
+	/* RMS averaging coefficient */
+	double alpha;
+	/* Previous input sample of the DC blocker */
+	int32_t dc_x1;
+	/* Previous output sample of the DC blocker */
+	double dc_y1;
+	/* Notch all-pole section state */
+	double xf1, xf2;
+	/* Tracked fundamental frequency, cycles per sample, updated once per
+	 * time constant while tracking (the notch coefficient is exact) */
+	double freq;
+	/* Mean square of the notch all-pole section output, gradient
+	 * normalization */
+	double ms_notch;
+	/* Previous DC blocked input sample of the acquisition */
+	double fund1;
+	/* Position of the first zero crossing of the acquisition estimate */
+	double last_crossing;
+	/* Fundamental acquired, notch tracking it */
+	bool locked;
+	/* Acquisition zero crossing armed, input below the hysteresis */
+	bool armed;
+	/* Zero crossings of the current acquisition estimate */
+	uint8_t acq_crossings;
+	/* Previous acquisition estimate of the period, samples */
+	double acq_period;
+	/* Sample the tracked frequency was last seen moving at, or locked at */
+	uint64_t stable_sample;
+	/* Start of the current convergence check */
+	uint64_t check_sample;
+	/* Tracked frequency at the start of the convergence check */
+	double check_freq;
+	/* Number of samples of a convergence check, a time constant */
+	uint64_t check_samples;
+	/* Max change of the tracked frequency over a check, cycles per sample */
+	double converged_tol;
+	/* Mean square of the signal, DC removed */
+	double ms_total;
+	/* Mean square of the notch output (harmonics and noise) */
+	double ms_residual;
+	/* Number of processed samples */
+	uint64_t samples;
+	/* Number of samples for the averages to settle */
+	uint64_t settling_samples;
+};
+
+/* THD+N analyzer result */
+struct adi_thdn_result {
+	/* THD+N in dB */
+	float thdn_db;
+	/* THD+N in percent */
+	float thdn_percent;
+	/* Tracked fundamental frequency in Hz */
+	float fund_freq;
+	/* RMS of the signal in codes, DC removed */
+	float rms_total;
+	/* RMS of the harmonics and noise in codes */
+	float rms_residual;
+	/* Fundamental locked, notch frequency converged and averages settled */
+	bool settled;
+};
+
+int adi_thdn_init(struct adi_thdn **desc,
+		  const struct adi_thdn_init_param *param);
+int adi_thdn_remove(struct adi_thdn *desc);
+void adi_thdn_reset(struct adi_thdn *desc);
+int adi_thdn_process(struct adi_thdn *desc, const int32_t *data, uint32_t len);
+int adi_thdn_get(struct adi_thdn *desc, struct adi_thdn_result *result);
+
+#endif	// !_ADI_THDN_H_
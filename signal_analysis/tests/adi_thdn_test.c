@@ -0,0 +1,162 @@
+/***************************************************************************//**
+ *   @file    adi_thdn_test.c
+ *   @brief   THD+N analyzer regression test
+ *   @details Host test of the fundamental acquisition and tracking, from
+ *	      initial frequencies far from the tone, up to a few samples per
+ *	      period. Build and run on the host:
+ *	      gcc -I.. adi_thdn_test.c ../adi_thdn.c -lm && ./a.out
+********************************************************************************
+ * Copyright (c) 2024 Analog Devices, Inc.
+ *
+ * This software is proprietary to Analog Devices, Inc. and its licensors.
+ * By using this software you agree to the terms of the associated
+ * Analog Devices Software License Agreement.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdio.h>
+#include <math.h>
+#include "adi_thdn.h"
+
+/******************************************************************************/
+/******************** Variables and User Defined Data Types *******************/
+/******************************************************************************/
+
+#define TEST_PI			3.14159265358979323846
+#define TEST_SAMPLE_RATE	48000.0
+#define TEST_BLOCK		480
+/* Seconds of signal per test case */
+#define TEST_DURATION		20
+/* Seconds of signal before the end at which the tone frequency steps */
+#define TEST_STEP_TIME		2
+/* Amplitude of the fundamental and mid-scale, 24-bit codes */
+#define TEST_AMPLITUDE		4000000.0
+#define TEST_MID_SCALE		8388608.0
+/* Accepted THD+N error, dB */
+#define TEST_TOLERANCE		0.1
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Measure the THD+N of a tone with a 3rd harmonic
+ * @param fund_freq[in] - Frequency of the tone in Hz
+ * @param step_freq[in] - Frequency of the tone over the last TEST_STEP_TIME
+ *			  seconds in Hz, 0 for no step
+ * @param harm_dbc[in] - Level of the 3rd harmonic, dBc
+ * @param init_freq[in] - Initial fundamental frequency of the analyzer in Hz
+ * @param adapt_rate[in] - Adaptation rate of the notch frequency
+ * @param result[out] - THD+N result
+ * @return 0 in case of success, negative error code otherwise
+ */
+static int test_thdn_run(double fund_freq, double step_freq, double harm_dbc,
+			 float init_freq, float adapt_rate,
+			 struct adi_thdn_result *result)
+{
+	struct adi_thdn_init_param param = {
+		.sample_rate = TEST_SAMPLE_RATE,
+		.fund_freq = init_freq,
+		.notch_bw = 20,
+		.adapt_rate = adapt_rate,
+		.time_constant = 0.5
+	};
+	const double harm = TEST_AMPLITUDE * pow(10.0, harm_dbc / 20.0);
+	struct adi_thdn *thdn;
+	int32_t data[TEST_BLOCK];
+	uint32_t block, cnt;
+	double t, phase = 0.0, freq;
+	int ret;
+
+	ret = adi_thdn_init(&thdn, &param);
+	if (ret)
+		return ret;
+
+	for (block = 0; block < TEST_DURATION * TEST_SAMPLE_RATE / TEST_BLOCK;
+	     block++) {
+		for (cnt = 0; cnt < TEST_BLOCK; cnt++) {
+			/* Phase continuous at the frequency step */
+			t = (block * TEST_BLOCK + cnt) / TEST_SAMPLE_RATE;
+			freq = (step_freq && t >= TEST_DURATION - TEST_STEP_TIME) ?
+			       step_freq : fund_freq;
+			data[cnt] = lround(TEST_MID_SCALE +
+					   TEST_AMPLITUDE * sin(phase) +
+					   harm * sin(3.0 * phase + 0.3));
+			phase = fmod(phase + 2.0 * TEST_PI * freq / TEST_SAMPLE_RATE,
+				     2.0 * TEST_PI);
+		}
+
+		ret = adi_thdn_process(thdn, data, TEST_BLOCK);
+		if (ret)
+			break;
+	}
+
+	if (!ret)
+		ret = adi_thdn_get(thdn, result);
+
+	adi_thdn_remove(thdn);
+
+	return ret;
+}
+
+int main(void)
+{
+	static const struct {
+		double fund_freq;
+		double step_freq;
+		double harm_dbc;
+		float init_freq;
+		float adapt_rate;
+	} cases[] = {
+		/* Initial frequencies far from the tone */
+		{ 103, 0, -60, 0, 0.05 },
+		{ 103, 0, -60, 2000, 0.05 },
+		{ 103, 0, -60, 6000, 0.05 },
+		{ 103, 0, -60, 100, 0.05 },
+		{ 103, 0, -60, 500, 0.05 },
+		/* DC blocker corner not set by the initial frequency */
+		{ 1003, 0, -60, 0, 0.05 },
+		{ 1003, 0, -80, 12000, 0.05 },
+		{ 50, 0, -60, 0, 0.05 },
+		/* A few samples per period, notch not moved off the tone */
+		{ 5000, 0, -60, 0, 0.05 },
+		{ 7000, 0, -60, 0, 0.05 },
+		{ 10000, 0, -60, 10000, 0.01 },
+		{ 10000, 0, -60, 10000, 0.001 },
+		{ 10000, 0, -60, 0, 0.05 },
+		{ 20000, 0, -60, 0, 0.05 },
+		/* Frequency step, averages not settled again */
+		{ 1003, 1013, -60, 0, 0.05 },
+	};
+	struct adi_thdn_result result;
+	unsigned int cnt, failures = 0;
+	double expected;
+	bool pass;
+
+	for (cnt = 0; cnt < sizeof(cases) / sizeof(cases[0]); cnt++) {
+		expected = cases[cnt].harm_dbc;
+		pass = !test_thdn_run(cases[cnt].fund_freq, cases[cnt].step_freq,
+				      cases[cnt].harm_dbc, cases[cnt].init_freq,
+				      cases[cnt].adapt_rate, &result);
+		/* Settled results only, and never right after a step */
+		if (cases[cnt].step_freq)
+			pass = pass && !result.settled;
+		else
+			pass = pass && result.settled
+			       && fabs(result.thdn_db - expected) <= TEST_TOLERANCE
+			       && fabs(result.fund_freq - cases[cnt].fund_freq) <=
+			       0.01 * cases[cnt].fund_freq;
+
+		printf("%s: %.0f Hz tone from %.0f Hz, rate %g, THD+N %.2f dB (%.2f dB), fund %.2f Hz, %s\n",
+		       pass ? "PASS" : "FAIL", cases[cnt].fund_freq, cases[cnt].init_freq,
+		       cases[cnt].adapt_rate, result.thdn_db, expected, result.fund_freq,
+		       result.settled ? "settled" : "not settled");
+		if (!pass)
+			failures++;
+	}
+
+	return failures ? 1 : 0;
+}